@@ -0,0 +1,372 @@
+// times the per-frame math of the hand pipeline on synthetic input
+// build in release, results are per call averaged over many calls
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+#include "quat_filter.h"
+#include "hand_kinematics.h"
+#include "flex_curl_table.h"
+#include "math_conversion.h"
+#include "pose_predictor.h"
+
+using namespace std;
+
+const float rad_to_deg = 180.0f / float(M_PI);
+
+// keeps results alive so the timed loops are not optimized away
+static volatile float sink;
+
+static quat random_rotation(mt19937& rng, float max_angle)
+{
+	uniform_real_distribution<float> u(-1.0f, 1.0f);
+	vec3 axis(u(rng), u(rng), u(rng));
+	axis.normalize();
+	return quat(axis, max_angle * u(rng));
+}
+
+// all IMUs of two hands through the one euro filter, as in vr_ctrl_panel::update_gloves()
+static void bench_quat_filter()
+{
+	const int num_frames = 20000;
+	size_t num_channels = 2 * max_num_imus;
+	quat_filter filter(num_channels);
+	mt19937 rng(1);
+	vector<quat> inputs(num_channels);
+	for (auto& q : inputs)
+	{
+		q = random_rotation(rng, 3.0f);
+	}
+
+	chrono::steady_clock::time_point t = chrono::steady_clock::now();
+	double total_us = 0;
+	for (int f = 0; f < num_frames; f++)
+	{
+		// 1 kHz samples with a little noise on a slow motion
+		t += chrono::milliseconds(1);
+		for (size_t c = 0; c < num_channels; c++)
+		{
+			inputs[c] = random_rotation(rng, .01f) * inputs[c];
+			inputs[c].normalize();
+			filter.set_input(c, inputs[c], t);
+		}
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		filter.process();
+		total_us += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+		sink = filter.get_output(0).w();
+	}
+
+	cout << "quat_filter, " << num_channels << " channels: " << total_us / num_frames << " us per frame" << endl;
+}
+
+// joint positions as hand::set_pose_and_actuators() built them before forward_kinematics():
+// each finger is constructed from distal to proximal, rotating and translating
+// all of its joints once per level, then the whole hand is scaled and translated
+static void forward_kinematics_reference(const part_rotation_array& rotations,
+	const array<vec3, NUM_HAND_PARTS>& bone_lengths, const array<vec3, num_palm_joints>& palm_resting,
+	float scale, vec3 position, joint_array& joints)
+{
+	auto rotate = [&](int part, quat rotation)
+	{
+		for (int i = part_begin(part); i < part_end(part); i++)
+		{
+			rotation.rotate(joints[i]);
+		}
+	};
+	auto translate = [&](int part, vec3 translation)
+	{
+		for (int i = part_begin(part); i < part_end(part); i++)
+		{
+			joints[i] += translation;
+		}
+	};
+
+	copy(palm_resting.begin(), palm_resting.end(), joints.begin() + part_begin(PALM));
+	rotate(PALM, rotations[PALM][0]);
+
+	for (int finger = THUMB; finger < NUM_HAND_PARTS; finger++)
+	{
+		for (int phalanx = DISTAL; phalanx >= PROXIMAL; phalanx--)
+		{
+			joints[joint_index(finger, phalanx)] = vec3(0);
+			translate(finger, vec3(0, 0, -bone_lengths[finger][phalanx]));
+			rotate(finger, rotations[finger][phalanx]);
+		}
+		translate(finger, joints[joint_index(PALM, finger)]);
+	}
+
+	for (auto& joint : joints)
+	{
+		joint = scale * joint + position;
+	}
+}
+
+// SSE and scalar forward kinematics of one hand against the construction they replaced
+static void bench_forward_kinematics()
+{
+	const int num_iterations = 200000;
+	mt19937 rng(2);
+	part_rotation_array rotations;
+	for (auto& part : rotations)
+	{
+		for (auto& q : part)
+		{
+			q = random_rotation(rng, .8f);
+		}
+	}
+	array<vec3, NUM_HAND_PARTS> bone_lengths;
+	bone_lengths.fill(vec3(.045f, .025f, .02f));
+	array<vec3, num_palm_joints> palm_resting;
+	for (size_t i = 0; i < num_palm_joints; i++)
+	{
+		palm_resting[i] = vec3(.02f * i - .07f, .0f, -.03f * (i % 3));
+	}
+	joint_array sse_joints, scalar_joints, reference_joints;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < num_iterations; i++)
+	{
+		forward_kinematics(rotations, bone_lengths, palm_resting, 1.0f, vec3(.001f * (i & 7)), sse_joints);
+		sink = sse_joints[num_joints - 1].z();
+	}
+	double sse_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / num_iterations;
+
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < num_iterations; i++)
+	{
+		forward_kinematics_scalar(rotations, bone_lengths, palm_resting, 1.0f, vec3(.001f * (i & 7)), scalar_joints);
+		sink = scalar_joints[num_joints - 1].z();
+	}
+	double scalar_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / num_iterations;
+
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < num_iterations; i++)
+	{
+		forward_kinematics_reference(rotations, bone_lengths, palm_resting, 1.0f, vec3(.001f * (i & 7)), reference_joints);
+		sink = reference_joints[num_joints - 1].z();
+	}
+	double reference_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / num_iterations;
+
+	forward_kinematics(rotations, bone_lengths, palm_resting, 1.0f, vec3(0), sse_joints);
+	forward_kinematics_scalar(rotations, bone_lengths, palm_resting, 1.0f, vec3(0), scalar_joints);
+	forward_kinematics_reference(rotations, bone_lengths, palm_resting, 1.0f, vec3(0), reference_joints);
+	float max_scalar_difference = 0, max_reference_difference = 0;
+	for (size_t i = 0; i < num_joints; i++)
+	{
+		max_scalar_difference = max(max_scalar_difference, (sse_joints[i] - scalar_joints[i]).length());
+		max_reference_difference = max(max_reference_difference, (sse_joints[i] - reference_joints[i]).length());
+	}
+
+	cout << "forward_kinematics: " << sse_ns << " ns per hand, scalar " << scalar_ns
+		<< " ns, old construction " << reference_ns << " ns" << endl;
+	cout << "  max difference to scalar " << 1e6f * max_scalar_difference
+		<< " um, to old construction " << 1e6f * max_reference_difference << " um" << endl;
+}
+
+// angle of a phalanx about the finger's x-axis
+static float curl_of(const quat& q)
+{
+	return 2 * atan2(q.x(), q.w());
+}
+
+// total curl of a finger from its IMU, split as in hand::set_rotations()
+static float imu_curl(quat finger, const vec3& rot_split)
+{
+	quat swing;
+	float curl_angle = math_conversion::swing_twist_x(finger, swing);
+	if (curl_angle > M_PI / 2)
+	{
+		curl_angle -= 2 * float(M_PI);
+	}
+	if (curl_angle >= 0)
+	{
+		return 0;
+	}
+
+	vec3 x(1, 0, 0);
+	quat proximal = swing * quat(x, rot_split.x() * curl_angle),
+		intermediate = quat(x, rot_split.y() * curl_angle),
+		distal = quat(x, min(1.4f, rot_split.z() * curl_angle));
+	return curl_of(proximal) + curl_of(intermediate) + curl_of(distal);
+}
+
+// phalanx rotations of a curled finger as hand::set_rotations() split them with Euler angles
+// before math_conversion::swing_twist_x(), the same reference tests/test_swing_twist.cpp compares against
+static void euler_split(const quat& rot, const vec3& rot_split, quat& proximal, quat& intermediate, quat& distal)
+{
+	float roll = atan2(
+		2 * (rot.w() * rot.x() + rot.y() * rot.z()),
+		1 - 2 * (rot.x() * rot.x() + rot.y() * rot.y())
+	);
+	float sinp = 2 * (rot.w() * rot.y() - rot.z() * rot.x()), pitch;
+	if (abs(sinp) >= 1)
+	{
+		pitch = copysign(float(M_PI) / 2, sinp);
+	}
+	else
+	{
+		pitch = asin(sinp);
+	}
+	float yaw = atan2(
+		2 * (rot.w() * rot.z() + rot.x() * rot.y()),
+		1 - 2 * (rot.y() * rot.y() + rot.z() * rot.z())
+	);
+
+	vec3 x(1, 0, 0), y(0, 1, 0), z(0, 0, 1);
+	proximal = quat(z, yaw) * quat(y, pitch) * quat(x, rot_split.x() * roll);
+	proximal.normalize();
+	intermediate = quat(x, rot_split.y() * roll);
+	intermediate.normalize();
+	distal = quat(x, min(1.4f, rot_split.z() * roll));
+	distal.normalize();
+}
+
+// total curl of a finger from its flex sensor
+static float flex_curl(float flex)
+{
+	const flex_curl_table::phalanx_rotations& curl = flex_curl_table::get_finger_table().lookup(flex);
+	return curl_of(curl.proximal) + curl_of(curl.intermediate) + curl_of(curl.distal);
+}
+
+// flex lookup against the IMU swing-twist split for the four fingers of a hand:
+// cost per hand next to the Euler split the swing-twist one replaced, spread of the curl of a still finger under sensor noise,
+// and the largest jump while the finger curls steadily
+static void bench_finger_curl()
+{
+	const int num_iterations = 200000, num_noise_samples = 10000, num_sweep_steps = 1000;
+	const vec3 rot_split(.5f, .5f, .25f);
+	// typical sensor noise: one flex step in 200, half a degree of IMU rotation
+	const float flex_noise = .005f, imu_noise = .5f / rad_to_deg;
+	mt19937 rng(3);
+	normal_distribution<float> n(.0f, 1.0f);
+
+	quat fingers[4];
+	float flexes[4];
+	for (int f = 0; f < 4; f++)
+	{
+		flexes[f] = .2f * f + .1f;
+		fingers[f] = random_rotation(rng, .1f) * quat(vec3(1, 0, 0), -1.5f * flexes[f]);
+	}
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	float total = 0;
+	for (int i = 0; i < num_iterations; i++)
+	{
+		for (int f = 0; f < 4; f++)
+		{
+			const flex_curl_table::phalanx_rotations& curl = flex_curl_table::get_finger_table().lookup(flexes[f]);
+			total += curl.distal.w();
+		}
+	}
+	double flex_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / num_iterations;
+
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < num_iterations; i++)
+	{
+		for (int f = 0; f < 4; f++)
+		{
+			quat swing;
+			float curl_angle = math_conversion::swing_twist_x(fingers[f], swing);
+			vec3 x(1, 0, 0);
+			quat proximal = swing * quat(x, rot_split.x() * curl_angle);
+			proximal.normalize();
+			quat intermediate(x, rot_split.y() * curl_angle),
+				distal(x, min(1.4f, rot_split.z() * curl_angle));
+			total += proximal.w() + intermediate.w() + distal.w();
+		}
+	}
+	double imu_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / num_iterations;
+
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < num_iterations; i++)
+	{
+		for (int f = 0; f < 4; f++)
+		{
+			quat proximal, intermediate, distal;
+			euler_split(fingers[f], rot_split, proximal, intermediate, distal);
+			total += proximal.w() + intermediate.w() + distal.w();
+		}
+	}
+	double euler_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / num_iterations;
+	sink = total;
+
+	// standard deviation of a half curled finger's total curl
+	double flex_sum = 0, flex_sum2 = 0, imu_sum = 0, imu_sum2 = 0;
+	quat half_curled(vec3(1, 0, 0), -.75f);
+	for (int i = 0; i < num_noise_samples; i++)
+	{
+		float a = flex_curl(.5f + flex_noise * n(rng));
+		flex_sum += a;
+		flex_sum2 += a * a;
+		float b = imu_curl(random_rotation(rng, imu_noise) * half_curled, rot_split);
+		imu_sum += b;
+		imu_sum2 += b * b;
+	}
+	double flex_std = sqrt(max(.0, flex_sum2 / num_noise_samples - pow(flex_sum / num_noise_samples, 2))),
+		imu_std = sqrt(max(.0, imu_sum2 / num_noise_samples - pow(imu_sum / num_noise_samples, 2)));
+
+	// largest change of the total curl between two steps of a steady curl from open to fist
+	float flex_jump = 0, imu_jump = 0, last_flex = flex_curl(0), last_imu = imu_curl(quat(1, 0, 0, 0), rot_split);
+	for (int i = 1; i <= num_sweep_steps; i++)
+	{
+		float s = i / float(num_sweep_steps);
+		float a = flex_curl(s), b = imu_curl(quat(vec3(1, 0, 0), -2.5f * s), rot_split);
+		flex_jump = max(flex_jump, abs(a - last_flex));
+		imu_jump = max(imu_jump, abs(b - last_imu));
+		last_flex = a;
+		last_imu = b;
+	}
+
+	cout << "finger curl per hand: flex " << flex_ns << " ns, IMU " << imu_ns << " ns, IMU by Euler angles " << euler_ns << " ns" << endl;
+	cout << "  curl noise: flex " << flex_std * rad_to_deg << " deg, IMU " << imu_std * rad_to_deg << " deg" << endl;
+	cout << "  largest step of a steady curl: flex " << flex_jump * rad_to_deg << " deg, IMU " << imu_jump * rad_to_deg << " deg" << endl;
+}
+
+// a finger IMU reaching and grasping at 1 kHz with sensor noise, predicted against held
+static void bench_prediction()
+{
+	const float duration_s = 10.0f, rate_hz = 1000.0f, noise = .2f / rad_to_deg;
+	const float horizons_ms[] = { 5.0f, 11.0f, 20.0f };
+	mt19937 rng(4);
+	normal_distribution<float> n(.0f, 1.0f);
+
+	vector<pair<chrono::steady_clock::time_point, quat>> recording;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < duration_s * rate_hz; i++)
+	{
+		float t = i / rate_hz;
+		// curl up to 90 degrees once a second while the hand turns slowly
+		quat motion = quat(vec3(0, 1, 0), .5f * sin(.7f * t)) * quat(vec3(1, 0, 0), -.8f * (1 - cos(2 * float(M_PI) * t)));
+		quat q = quat(vec3(0, 0, 1), noise * n(rng)) * quat(vec3(1, 0, 0), noise * n(rng)) * motion;
+		q.normalize();
+		recording.push_back({ start + chrono::microseconds((long long)(1e6f * t)), q });
+	}
+
+	for (float horizon_ms : horizons_ms)
+	{
+		// error of showing the newest sample, what the hand did before prediction
+		size_t offset = (size_t)(horizon_ms * rate_hz / 1000);
+		float held_sum = 0;
+		for (size_t i = 0; i + offset < recording.size(); i++)
+		{
+			held_sum += rotation_predictor::angle_between(recording[i].second, recording[i + offset].second);
+		}
+		float held_deg = rad_to_deg * held_sum / (recording.size() - offset);
+
+		cout << "prediction " << horizon_ms << " ms ahead: " << pose_predictor::replay_error_deg(recording, horizon_ms)
+			<< " deg mean error, held " << held_deg << " deg" << endl;
+	}
+}
+
+int main()
+{
+	cout << fixed << setprecision(3);
+	bench_quat_filter();
+	bench_forward_kinematics();
+	bench_finger_curl();
+	bench_prediction();
+	return 0;
+}
@@ -1,4 +1,67 @@
 #include "conn_panel.h"
+
+#include <algorithm>
+
+// writes the vibration strength of each joint of ci to strengths, 0 if it touches nothing
+// only visits the elements near a joint, their ancestors and the elements hand_index touched last time
+
+void conn_panel::check_containments(const containment_info& ci, int hand_index, float* strengths)
+{
+	fill(strengths, strengths + ci.num_positions, .0f);
+	if (hand_index >= (int)touched_nodes.size())
+	{
+		touched_nodes.resize(hand_index + 1);
+	}
+
+	bvh.update();
+	candidate_nodes.clear();
+	for (size_t i = 0; i < ci.num_positions; i++)
+	{
+		bvh.query(ci.positions[i], ci.tolerance, i, candidate_nodes);
+	}
+
+	// a touch counts for the touched element and everything above it
+	query_nodes.clear();
+	for (auto n : candidate_nodes)
+	{
+		uint64_t joints = n->test_candidates(ci, strengths);
+		for (; joints && n; n = n->get_parent())
+		{
+			uint64_t old_joints = n->get_query_joints();
+			if ((old_joints | joints) == old_joints)
+			{
+				break;
+			}
+			if (n->add_query_joints(joints))
+			{
+				query_nodes.push_back(n);
+			}
+		}
+	}
+
+	// children first, as the recursive traversal did
+	sort(query_nodes.begin(), query_nodes.end(),
+		[](panel_node* a, panel_node* b) { return a->get_depth() > b->get_depth(); });
+	for (auto n : query_nodes)
+	{
+		n->set_touches(ci, hand_index, n->get_query_joints());
+	}
+
+	// released elements
+	for (auto n : touched_nodes[hand_index])
+	{
+		if (!n->get_query_joints())
+		{
+			n->set_touches(ci, hand_index, 0);
+		}
+	}
+
+	for (auto n : query_nodes)
+	{
+		n->clear_query_joints();
+	}
+	swap(touched_nodes[hand_index], query_nodes);
+}
 //
 //#pragma once
 //
@@ -7,22 +7,41 @@
 #include <cgv_gl/gl/gl.h>
 
 #include "panel_element.h"
+#include "panel_bvh.h"
 #include "space.h"
 
 using namespace std;
 
 vec3 const panel_pos_on_bridge = vec3(-.005f, .885f, -3.627f);
 
+// panel boxes and controlled space as drawn, published by the simulation
+struct panel_state
+{
+	group_geometry geometry;
+	// geometry is only copied when the panel changed
+	unsigned geometry_version = 0;
+	space_state space;
+};
+
 class conn_panel
 	: public cgv::render::drawable
 {
 protected:
 	panel_node* panel_tree;
 	space* controlled_space;
+	// increased whenever a panel element changed its geometry
+	unsigned geometry_version;
+	// narrows containment checks down to the elements near each joint
+	panel_bvh bvh;
+	// per hand, the elements touched by the last check_containments() call
+	vector<vector<panel_node*>> touched_nodes;
+	// reused by check_containments() so that it does not allocate
+	vector<panel_node*> candidate_nodes, query_nodes;
 
 public:
 
 	conn_panel()
+		: geometry_version(1)
 	{
 		controlled_space = new space(10.0f, 1000.0f);
 		panel_tree = new panel_node();
@@ -77,11 +96,31 @@ public:
 			controlled_space, space::static_fire,
 			right_panel
 		);
+
+		bvh.build(panel_tree);
 	}
 	
-	void draw(cgv::render::context& ctx)
+	// advances the controlled space, called by the simulation
+	void update() { controlled_space->update(); }
+
+	// copies the current state to s
+	void publish(panel_state& s)
 	{
-		group_geometry gg = panel_tree->get_geometry_rec();
+		if (panel_tree->geometry_changed())
+		{
+			geometry_version++;
+		}
+		if (s.geometry_version != geometry_version)
+		{
+			s.geometry = panel_tree->get_geometry_rec();
+			s.geometry_version = geometry_version;
+		}
+		controlled_space->publish(s.space);
+	}
+
+	void draw(cgv::render::context& ctx, const panel_state& s)
+	{
+		const group_geometry& gg = s.geometry;
 		cgv::render::box_renderer& br = cgv::render::ref_box_renderer(ctx);
 		br.set_position_is_center(true);
 		br.set_position_array(ctx, gg.positions);
@@ -93,11 +132,10 @@ public:
 		glDrawArrays(GL_POINTS, 0, gg.positions.size());
 		br.disable(ctx);
 
-		controlled_space->draw(ctx);
+		controlled_space->draw(ctx, s.space);
 	}
 
-	std::map<int, float> check_containments(containment_info ci, int hand_loc) const
-	{
-		return panel_tree->check_containments(ci, hand_loc);
-	}
-};
\ No newline at end of file
+	// writes the vibration strength of each joint of ci to strengths, 0 if it touches nothing
+	// only visits the elements near a joint, their ancestors and the elements hand_index touched last time
+	void check_containments(const containment_info& ci, int hand_index, float* strengths);
+};
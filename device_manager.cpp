@@ -0,0 +1,229 @@
+#include "device_manager.h"
+
+device_manager::~device_manager()
+{
+	stop();
+	for (auto& entry : backends)
+	{
+		try
+		{
+			if (entry.state == LIVE || entry.state == DEGRADED)
+			{
+				entry.backend->close_connection();
+			}
+			delete entry.backend;
+		}
+		catch (const std::exception& e)
+		{
+			cout << e.what();
+		}
+	}
+}
+
+void device_manager::add_backend(glove_backend* backend)
+{
+	lock_guard<mutex> lock(entries_mutex);
+	backends.push_back({ backend, DISCONNECTED, DISCONNECTED });
+}
+
+void device_manager::start()
+{
+	if (is_running)
+	{
+		return;
+	}
+
+	is_running = true;
+	worker = thread(&device_manager::run, this);
+}
+
+void device_manager::stop()
+{
+	is_running = false;
+	if (worker.joinable())
+	{
+		worker.join();
+	}
+}
+
+void device_manager::run()
+{
+	while (is_running)
+	{
+		size_t num_backends;
+		{
+			lock_guard<mutex> lock(entries_mutex);
+			num_backends = backends.size();
+		}
+
+		for (size_t i = 0; i < num_backends && is_running; i++)
+		{
+			glove_backend* backend;
+			connection_state state;
+			{
+				lock_guard<mutex> lock(entries_mutex);
+				backend = backends[i].backend;
+				state = backends[i].state;
+			}
+			set_state(i, update_backend(i, backend, state));
+		}
+
+		this_thread::sleep_for(poll_period);
+	}
+}
+
+device_manager::connection_state device_manager::update_backend(size_t backend_index, glove_backend* backend, connection_state state)
+{
+	if (state == DISCONNECTED)
+	{
+		set_state(backend_index, CONNECTING);
+		// 0 on success, an NDAPISpace::Error otherwise
+		int result = backend->connect_to_server();
+		if (result != 0)
+		{
+			// an unavailable service is retried quietly every poll_period
+			if (result != NDAPISpace::ND_ERROR_SERVICE_UNAVAILABLE)
+			{
+				cout << "Glove backend " << backend_index << " could not connect, error " << result << "." << endl;
+			}
+			return DISCONNECTED;
+		}
+	}
+
+	bool are_all_connected;
+	if (!enumerate(backend, are_all_connected))
+	{
+		backend->close_connection();
+		return DISCONNECTED;
+	}
+
+	return are_all_connected ? LIVE : DEGRADED;
+}
+
+bool device_manager::enumerate(glove_backend* backend, bool& are_all_connected)
+{
+	are_all_connected = true;
+
+	int num_dev = backend->get_number_of_devices();
+	if (num_dev == NDAPISpace::ND_ERROR_SERVICE_UNAVAILABLE)
+	{
+		return false;
+	}
+
+	vector<int> ids(max(num_dev, 0));
+	if (num_dev > 0)
+	{
+		num_dev = max(backend->get_devices_id(ids.data(), num_dev), 0);
+		ids.resize(min((size_t)num_dev, ids.size()));
+	}
+
+	// gloves reported now, their locations and connection states
+	vector<int> locations(ids.size()), connected(ids.size());
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		locations[i] = backend->get_device_location(ids[i]);
+		connected[i] = backend->is_connected(ids[i]);
+	}
+
+	lock_guard<mutex> lock(entries_mutex);
+	// gloves known before but no longer reported are disconnected
+	for (auto& d : devices)
+	{
+		if (d.backend == backend)
+		{
+			d.is_connected = false;
+		}
+	}
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		if (locations[i] != NDAPISpace::LOC_LEFT_HAND && locations[i] != NDAPISpace::LOC_RIGHT_HAND)
+		{
+			continue;
+		}
+
+		size_t d = 0;
+		while (d < devices.size() && (devices[d].backend != backend || devices[d].id != ids[i]))
+		{
+			d++;
+		}
+		if (d == devices.size())
+		{
+			devices.push_back({ backend, ids[i], (NDAPISpace::Location)locations[i], false });
+			cout << (locations[i] == NDAPISpace::LOC_LEFT_HAND ? "Left" : "Right") << " hand device connected." << endl;
+		}
+		devices[d].is_connected = connected[i] == 1;
+	}
+	for (auto& d : devices)
+	{
+		if (d.backend == backend)
+		{
+			are_all_connected &= d.is_connected;
+		}
+	}
+
+	return true;
+}
+
+void device_manager::set_state(size_t backend_index, connection_state state)
+{
+	const char* names[] = { "disconnected", "connecting", "live", "degraded" };
+
+	lock_guard<mutex> lock(entries_mutex);
+	backend_entry& entry = backends[backend_index];
+	entry.state = state;
+	if (state != CONNECTING && state != entry.reported_state)
+	{
+		cout << "Glove backend " << backend_index << " " << names[state] << "." << endl;
+		entry.reported_state = state;
+	}
+}
+
+int device_manager::get_number_of_devices() const
+{
+	lock_guard<mutex> lock(entries_mutex);
+	return devices.size();
+}
+
+int device_manager::find_device(NDAPISpace::Location location) const
+{
+	lock_guard<mutex> lock(entries_mutex);
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		if (devices[i].location == location)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+glove_backend* device_manager::get_backend(int device) const
+{
+	lock_guard<mutex> lock(entries_mutex);
+	return devices[device].backend;
+}
+
+int device_manager::get_backend_id(int device) const
+{
+	lock_guard<mutex> lock(entries_mutex);
+	return devices[device].id;
+}
+
+NDAPISpace::Location device_manager::get_location(int device) const
+{
+	lock_guard<mutex> lock(entries_mutex);
+	return devices[device].location;
+}
+
+bool device_manager::is_device_connected(int device) const
+{
+	lock_guard<mutex> lock(entries_mutex);
+	return devices[device].is_connected;
+}
+
+device_manager::connection_state device_manager::get_state(size_t backend_index) const
+{
+	lock_guard<mutex> lock(entries_mutex);
+	return backends[backend_index].state;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+#include "glove_backend.h"
+
+using namespace std;
+
+// owns any number of glove backends and enumerates their devices
+// devices are addressed by their index in this manager,
+// so ids of different backends can never collide
+//
+// connecting, enumerating and reconnecting happen on a thread of its own,
+// devices are only ever appended and keep their index after a reconnect
+class device_manager
+{
+public:
+	enum connection_state
+	{
+		// service not reachable
+		DISCONNECTED,
+		// connectToServer() is running
+		CONNECTING,
+		// connected, all known gloves are connected
+		LIVE,
+		// connected, but at least one known glove is not
+		DEGRADED
+	};
+
+private:
+	// a glove as seen by the application
+	struct device_entry
+	{
+		glove_backend* backend;
+		// id within backend
+		int id;
+		NDAPISpace::Location location;
+		bool is_connected;
+	};
+
+	struct backend_entry
+	{
+		// owned
+		glove_backend* backend;
+		connection_state state;
+		// last state written to cout, connection attempts are not reported
+		connection_state reported_state;
+	};
+
+	// guards backends and devices, never held during a backend call
+	mutable mutex entries_mutex;
+	vector<backend_entry> backends;
+	vector<device_entry> devices;
+
+	atomic<bool> is_running;
+	thread worker;
+	const chrono::milliseconds poll_period = chrono::milliseconds(1000);
+
+	device_manager(const device_manager&);
+	device_manager& operator = (const device_manager&);
+
+	void run();
+
+	// one step of a backend's state machine, returns its new state
+	connection_state update_backend(size_t backend_index, glove_backend* backend, connection_state state);
+
+	// adds gloves the backend did not report before and refreshes is_connected
+	// returns false if the service went away
+	bool enumerate(glove_backend* backend, bool& are_all_connected);
+
+	void set_state(size_t backend_index, connection_state state);
+
+public:
+	device_manager()
+		: is_running(false)
+	{}
+
+	~device_manager();
+
+	// takes ownership, the backend is connected in the background
+	void add_backend(glove_backend* backend);
+
+	// starts connecting and watching the backends
+	void start();
+
+	void stop();
+
+	int get_number_of_devices() const;
+
+	// index of the first device at location, -1 if there is none
+	// devices of backends added first are preferred
+	int find_device(NDAPISpace::Location location) const;
+
+	glove_backend* get_backend(int device) const;
+	// id of device within its backend
+	int get_backend_id(int device) const;
+	NDAPISpace::Location get_location(int device) const;
+	bool is_device_connected(int device) const;
+
+	connection_state get_state(size_t backend_index) const;
+};
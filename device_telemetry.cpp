@@ -0,0 +1,143 @@
+#include "device_telemetry.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	const char* connection_name(int connection_type)
+	{
+		const char* names[] = { "disconnected", "usb", "bluetooth", "virtual" };
+		return connection_type >= 0 && connection_type < 4 ? names[connection_type] : "unknown";
+	}
+}
+
+device_telemetry::device_telemetry(const device_manager& dm)
+	: devices(dm), num_devices(0), version(0), is_running(false)
+{
+	for (auto& s : slots)
+	{
+		s.battery_level = -1;
+		s.is_connected = false;
+		s.connection_type = -1;
+	}
+}
+
+void device_telemetry::start()
+{
+	if (is_running)
+	{
+		return;
+	}
+
+	is_running = true;
+	worker = thread(&device_telemetry::run, this);
+}
+
+void device_telemetry::stop()
+{
+	is_running = false;
+	if (worker.joinable())
+	{
+		worker.join();
+	}
+}
+
+void device_telemetry::run()
+{
+	while (is_running)
+	{
+		poll();
+
+		// sleep in short steps so stop() does not wait a whole period
+		chrono::steady_clock::time_point next_poll = chrono::steady_clock::now() + poll_period;
+		while (is_running && chrono::steady_clock::now() < next_poll)
+		{
+			this_thread::sleep_for(chrono::milliseconds(100));
+		}
+	}
+}
+
+void device_telemetry::poll()
+{
+	int n = min(devices.get_number_of_devices(), max_num_devices);
+	for (int i = 0; i < n; i++)
+	{
+		glove_backend* backend = devices.get_backend(i);
+		int id = devices.get_backend_id(i);
+
+		float level = -1;
+		if (backend->get_battery_level(level, id) != 0)
+		{
+			level = -1;
+		}
+		slots[i].battery_level = level;
+		slots[i].is_connected = backend->is_connected(id) == 1;
+		slots[i].connection_type = backend->get_connection_type(id);
+	}
+	num_devices = n;
+	version++;
+}
+
+device_telemetry::device_state device_telemetry::get(int device) const
+{
+	device_state s;
+	s.battery_level = slots[device].battery_level;
+	s.is_connected = slots[device].is_connected;
+	s.connection_type = slots[device].connection_type;
+
+	return s;
+}
+
+string device_telemetry::get_warnings() const
+{
+	stringstream ss;
+	for (int i = 0; i < num_devices; i++)
+	{
+		device_state s = get(i);
+		if (!s.is_connected)
+		{
+			ss << "Glove " << i << " disconnected" << endl;
+		}
+		else if (s.battery_level >= 0 && s.battery_level < low_battery_level)
+		{
+			ss << "Glove " << i << " battery " << (int)(100 * s.battery_level) << "%" << endl;
+		}
+	}
+
+	return ss.str();
+}
+
+string device_telemetry::get_summary() const
+{
+	stringstream ss;
+	for (int i = 0; i < num_devices; i++)
+	{
+		device_state s = get(i);
+		ss << "glove " << i << ": " << (s.is_connected ? "connected" : "not connected")
+			<< " via " << connection_name(s.connection_type)
+			<< ", battery " << (s.battery_level < 0 ? string("unknown") : to_string((int)(100 * s.battery_level)) + "%") << endl;
+	}
+
+	return ss.str();
+}
+
+bool device_telemetry::write_csv(const string& file_name) const
+{
+	ofstream csv_file(file_name);
+	if (!csv_file.good())
+	{
+		cout << "Could not write " << file_name << "." << endl;
+		return false;
+	}
+
+	csv_file << "device,is_connected,connection_type,battery_level" << endl;
+	for (int i = 0; i < num_devices; i++)
+	{
+		device_state s = get(i);
+		csv_file << i << "," << s.is_connected << "," << connection_name(s.connection_type) << "," << s.battery_level << endl;
+	}
+
+	csv_file.close();
+	return true;
+}
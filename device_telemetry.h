@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+
+#include "device_manager.h"
+
+using namespace std;
+
+// battery and connection state of all gloves
+// polled on a slow thread of its own, read without locks
+class device_telemetry
+{
+public:
+	// gloves beyond this are not monitored
+	static const int max_num_devices = 16;
+
+	struct device_state
+	{
+		// between 0 and 1, negative if unknown
+		float battery_level;
+		bool is_connected;
+		// NDAPISpace::ConnectionType, negative if unknown
+		int connection_type;
+	};
+
+private:
+	struct device_slot
+	{
+		atomic<float> battery_level;
+		atomic<bool> is_connected;
+		atomic<int> connection_type;
+	};
+
+	const device_manager& devices;
+	device_slot slots[max_num_devices];
+	atomic<int> num_devices;
+	// increased after every poll, lets readers skip unchanged states
+	atomic<unsigned> version;
+
+	atomic<bool> is_running;
+	thread worker;
+	const chrono::milliseconds poll_period = chrono::milliseconds(5000);
+
+	void run();
+
+	void poll();
+
+public:
+	// gloves below this level are reported on the head up display
+	const float low_battery_level = .15f;
+
+	device_telemetry(const device_manager& dm);
+
+	~device_telemetry() { stop(); }
+
+	void start();
+
+	void stop();
+
+	int get_number_of_devices() const { return num_devices; }
+
+	unsigned get_version() const { return version; }
+
+	device_state get(int device) const;
+
+	// one line per glove that is disconnected or low on battery, empty if all are fine
+	string get_warnings() const;
+
+	// one line per glove
+	string get_summary() const;
+
+	bool write_csv(const string& file_name) const;
+};
@@ -0,0 +1,29 @@
+#include "flex_curl_table.h"
+
+#include <algorithm>
+
+flex_curl_table::flex_curl_table(vec3 max_angles)
+{
+	// fingers curl around negative x in cgv space
+	vec3 x(1, 0, 0);
+	for (size_t i = 0; i < num_entries; i++)
+	{
+		float flex = i / float(num_entries - 1);
+		entries[i].proximal = quat(x, -flex * max_angles.x());
+		entries[i].intermediate = quat(x, -flex * max_angles.y());
+		entries[i].distal = quat(x, -flex * max_angles.z());
+	}
+}
+
+const flex_curl_table::phalanx_rotations& flex_curl_table::lookup(float flex) const
+{
+	flex = min(max(flex, .0f), 1.0f);
+	return entries[(int)(flex * (num_entries - 1) + .5f)];
+}
+
+const flex_curl_table& flex_curl_table::get_finger_table()
+{
+	// roughly the range of motion of the finger joints
+	static const flex_curl_table table(vec3(1.57f, 1.75f, 1.4f));
+	return table;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "nd_device.h"
+
+// maps a flex sensor value to the rotations of a finger's phalanges
+// all rotations are computed once, a lookup needs no trigonometry
+class flex_curl_table
+{
+public:
+	struct phalanx_rotations
+	{
+		// proximal relative to the palm, the others relative to their parent
+		quat proximal, intermediate, distal;
+	};
+
+	static const int num_entries = 256;
+
+	// max_angles are the phalanges' curl in rad at flex value 1
+	flex_curl_table(vec3 max_angles);
+
+	// flex is clamped to [0, 1]
+	const phalanx_rotations& lookup(float flex) const;
+
+	// table for index to pinky
+	static const flex_curl_table& get_finger_table();
+
+private:
+	phalanx_rotations entries[num_entries];
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "NDAPI.h"
+
+// maximum number of IMUs a device can report
+const int max_num_imus = NDAPISpace::IMULOC_FOREARM + 1;
+// palm, thumb, index, middle as in NDAPISpace::Contact
+const int max_num_contacts = 4;
+// number of NDAPISpace::Flex values
+const int max_num_flex = NDAPISpace::FLEX_PINKY + 1;
+// number of NDAPISpace::Actuator values
+const int max_num_actuators = NDAPISpace::ACT_PALM_MIDDLE_UP + 1;
+
+// source of glove data and sink of actuator commands
+// mirrors the part of NDAPISpace::NDAPI this application uses,
+// return values follow NDAPI conventions (negative NDAPISpace::Error on failure)
+class glove_backend
+{
+public:
+	virtual ~glove_backend() {}
+
+	// server
+	virtual int connect_to_server() = 0;
+	virtual int close_connection() = 0;
+	virtual int get_number_of_devices() = 0;
+	virtual int get_devices_id(int* ids, int num_ids) = 0;
+
+	// device info
+	virtual int get_device_location(int device_id) = 0;
+	virtual int is_connected(int device_id) = 0;
+	virtual int get_info(NDAPISpace::DriverInfo param, float& value, int device_id) = 0;
+	// NDAPISpace::ConnectionType
+	virtual int get_connection_type(int device_id) = 0;
+	// level between 0 and 1
+	virtual int get_battery_level(float& level, int device_id) = 0;
+
+	// sensors
+	virtual int get_number_of_imus(int device_id) = 0;
+	virtual int get_rotations(NDAPISpace::imu_sensor_t* imus, int num_imus, int device_id) = 0;
+	virtual int get_palm_acceleration(NDAPISpace::vector3d_t& acceleration, int device_id) = 0;
+	virtual int get_number_of_contacts(int device_id) = 0;
+	virtual int get_contacts_state(int* values, int num_values, int device_id) = 0;
+	virtual int get_number_of_flex(int device_id) = 0;
+	virtual int get_flex_state(float* values, int num_values, int device_id) = 0;
+
+	// actuators
+	// 1 if the device has the actuator, 0 if not
+	virtual int has_actuator(NDAPISpace::Actuator act, int device_id) = 0;
+	virtual int set_actuators_state(const float* levels, int num_values, int device_id) = 0;
+	virtual int set_actuators_stop(int device_id) = 0;
+};
@@ -0,0 +1,106 @@
+#include "glove_sampler.h"
+
+glove_sampler::glove_sampler(glove_backend* a_backend, int a_device_id, int a_num_imus)
+	: backend(a_backend), device_id(a_device_id), is_running(false)
+{
+	num_imus = min(a_num_imus, max_num_imus);
+	num_contacts = min(backend->get_number_of_contacts(device_id), max_num_contacts);
+	num_flex = max(min(backend->get_number_of_flex(device_id), max_num_flex), 0);
+
+	float rate_hz = 0;
+	if (backend->get_info(NDAPISpace::INFO_IMU_FPS, rate_hz, device_id) != 0 || rate_hz <= 0)
+	{
+		rate_hz = default_rate_hz;
+	}
+	period = chrono::microseconds((long long)(1e6f / rate_hz));
+}
+
+void glove_sampler::start()
+{
+	if (is_running)
+	{
+		return;
+	}
+
+	is_running = true;
+	worker = thread(&glove_sampler::run, this);
+}
+
+void glove_sampler::stop()
+{
+	is_running = false;
+	if (worker.joinable())
+	{
+		worker.join();
+	}
+}
+
+void glove_sampler::run()
+{
+	glove_sample sample;
+	chrono::steady_clock::time_point next_poll = chrono::steady_clock::now();
+	while (is_running)
+	{
+		// a glove that is not connected keeps its last sample
+		if (poll(sample))
+		{
+			ring.push(sample);
+		}
+
+		next_poll += period;
+		// do not try to catch up after the service stalled
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		if (next_poll < now)
+		{
+			next_poll = now;
+		}
+		this_thread::sleep_until(next_poll);
+	}
+}
+
+bool glove_sampler::poll(glove_sample& sample)
+{
+	if (backend->get_rotations(sample.imus, num_imus, device_id) != 0)
+	{
+		return false;
+	}
+
+	// all contacts in one call instead of one call per pair
+	int states[max_num_contacts] = { 0 };
+	if (num_contacts > 0)
+	{
+		backend->get_contacts_state(states, num_contacts, device_id);
+	}
+	sample.joined_contacts = joined_contacts_from_states(states, num_contacts);
+	sample.has_palm_acceleration = backend->get_palm_acceleration(sample.palm_acceleration, device_id) == 0;
+	// all flex sensors in one call
+	if (num_flex > 0)
+	{
+		backend->get_flex_state(sample.flex, num_flex, device_id);
+	}
+	sample.timestamp = chrono::steady_clock::now();
+
+	return true;
+}
+
+int glove_sampler::joined_contacts_from_states(const int* states, int num_states)
+{
+	// states are ordered like NDAPISpace::Contact: palm, thumb, index, middle
+	// a pressed contact reports the group it belongs to, joined contacts share a group
+	const int pairs[NUM_CONTACT_PAIRS][2] = {
+		{ 1, 2 }, { 1, 3 }, { 0, 2 }, { 0, 3 }
+	};
+
+	int result = 0;
+	for (size_t p = 0; p < NUM_CONTACT_PAIRS; p++)
+	{
+		int a = pairs[p][0], b = pairs[p][1];
+		if (a < num_states && b < num_states
+			&& states[a] > 0 && states[a] == states[b])
+		{
+			result |= 1 << p;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "glove_backend.h"
+#include "sample_ring.h"
+
+using namespace std;
+
+// pairs of contacts that make up the gestures used for interaction
+// bit indices in glove_sample::joined_contacts
+enum contact_pair
+{
+	THUMB_INDEX, THUMB_MIDDLE, PALM_INDEX, PALM_MIDDLE, NUM_CONTACT_PAIRS
+};
+
+// one reading of a glove's sensors
+struct glove_sample
+{
+	chrono::steady_clock::time_point timestamp;
+	NDAPISpace::imu_sensor_t imus[max_num_imus];
+	// bit p is set if contact_pair p is joined
+	int joined_contacts;
+	// bend per NDAPISpace::Flex, only valid if the glove has flex sensors
+	float flex[max_num_flex];
+	// palm IMU, in g including gravity and in NDAPI coords
+	NDAPISpace::vector3d_t palm_acceleration;
+	bool has_palm_acceleration;
+};
+
+// polls a glove at its native rate on a thread of its own
+// so that slow NDAPI calls never stall the render thread
+class glove_sampler
+{
+	glove_backend* backend;
+	int device_id, num_imus, num_contacts, num_flex;
+	chrono::microseconds period;
+	// used if the driver does not report its IMU rate
+	const float default_rate_hz = 100.0f;
+
+	sample_ring<glove_sample, 16> ring;
+	atomic<bool> is_running;
+	thread worker;
+
+	void run();
+
+	// returns false if the glove could not be read
+	bool poll(glove_sample& sample);
+
+	// evaluates the contact groups reported by getContactsState()
+	static int joined_contacts_from_states(const int* states, int num_states);
+
+public:
+	// a_device_id is the id within a_backend
+	glove_sampler(glove_backend* a_backend, int a_device_id, int a_num_imus);
+
+	~glove_sampler() { stop(); }
+
+	// 0 if the glove has no flex sensors
+	int get_number_of_flex() const { return num_flex; }
+
+	void start();
+
+	void stop();
+
+	// writes the newest sample to sample
+	// returns false and leaves sample untouched if none arrived since the last call
+	bool get_latest(glove_sample& sample) { return ring.pop_latest(sample); }
+
+	// writes the oldest sample not taken yet to sample, for consumers that need every sample
+	bool get_next(glove_sample& sample) { return ring.pop(sample); }
+};
@@ -21,72 +21,31 @@
 #include <cgv/gui/event_handler.h>
 
 #include "nd_device.h"
-#include "nd_handler.h"
+#include "hand_layout.h"
+#include "hand_kinematics.h"
+#include "pose_predictor.h"
+#include "flex_curl_table.h"
+#include "palm_fusion.h"
+#include "haptic_library.h"
 #include "conn_panel.h"
 #include "math_conversion.h"
 
 using namespace std;
 
+// hand as drawn, published by the simulation
+struct hand_state
+{
+	joint_array pose;
+	// glove sample the pose is based on
+	chrono::steady_clock::time_point sample_time;
+	// arrival of the tracker pose the pose is based on
+	chrono::steady_clock::time_point pose_time;
+};
+
 class hand
 	: public cgv::base::node,
 	public cgv::render::drawable
 {
-	enum hand_parts
-	{
-		PALM, THUMB, INDEX, MIDDLE, RING, PINKY, NUM_HAND_PARTS
-	};
-
-	enum phalanges
-	{
-		PROXIMAL, INTERMED, DISTAL, NUM_BONES_PER_FINGER
-	};
-
-	struct joint_positions {
-		// positions of hand joints in model space
-		// structure: hand_part<phalanx<position>>
-		vector<vector<vec3>> positions;
-		// positions linearized in hand_part major format
-		// set by make_array() 
-		vector<vec3> linearized;
-		// correspondence of indices in linearized
-		// to double indices in positions
-		map<int, pair<int, int>> lin_to_anat;
-
-		joint_positions()
-		{
-			for (size_t i = 0; i < NUM_HAND_PARTS; i++)
-			{
-				positions.push_back(vector<vec3>(NUM_BONES_PER_FINGER));
-			}
-		}
-
-		void push_back(int part, vec3 v)
-		{
-			positions[part].push_back(v);
-		}
-
-		// rotate complete part
-		void rotate(int part, quat rotation);
-
-		// translate complete part
-		void translate(int part, vec3 translation);
-
-		// translate complete part along neg. z-axis
-		void translate_neg_z(int part, float z);
-
-		// translate all positions
-		// used to move hand from construction origin
-		// to model view location
-		void translate(vec3 translation);
-
-		// scale all positions
-		// used to realize hand size at construction origin
-		void scale(float scale);
-
-		// generate linearized from positions
-		vector<vec3> make_array();
-	};
-
 public:
 	enum pulse_kind
 	{
@@ -96,39 +55,64 @@ public:
 protected:
 	// glove
 	nd_device device;
+	// index among all hands, used as slot in panel_node
+	int index;
+	// glove state of the current frame
+	glove_snapshot glove;
+	// shared by all hands, may be nullptr
+	latency_stats* stats;
+	// blends tracker poses with the palm IMU
+	palm_fusion fusion;
+	// extrapolates the fused palm pose and IMUs to display time
+	pose_predictor predictor;
 
 	// geometry
-	joint_positions pose;
-	vector<vector<quat>> recursive_rotations;
-	vector<vec3> bone_lengths, palm_resting;
-	vector<GLuint> cone_inds;
+	// positions of all joints in model space
+	joint_array pose;
+	part_rotation_array recursive_rotations;
+	// per part, the palm's is unused
+	array<vec3, NUM_HAND_PARTS> bone_lengths;
+	array<vec3, num_palm_joints> palm_resting;
+	// hand pose handed to the panel, reused every frame
+	containment_info ci;
+	// split of the IMU curl to the phalanges
 	const vec3 rot_split = vec3(.5f, .5f, .25f);
+	// curl fingers by flex sensors instead of IMUs if the glove has them
+	bool use_flex;
 
 	// calibration
 	quat last_palm_ref, palm_ref;
 	const float scale = .007f;
 	
 	// actuators and pulses
-	map<pair<int, int>, NDAPISpace::Actuator> anat_to_actuators;
-	chrono::steady_clock::time_point pulse_start;
-	pulse_kind current_pulse;
-	int num_delivered_pulses;
-	const int num_part_pulses_abort = 3, 
-		duration_done_pulse_ms = 1000, 
-		duration_abort_pulse = 600;
+	// interaction feedback, compiled in init()
+	haptic_library haptics;
+	// actuator under each joint if the glove has it, -1 otherwise
+	array<int, num_joints> joint_to_actuator;
 
 	// rendering
 	sphere_render_style srs;
 	rounded_cone_render_style rcrs;
+	array<float, num_joints> radii;
+	vector<GLuint> cone_inds;
+	// GPU copies of the joint attributes, radii and indices are uploaded once
+	attribute_array_manager sphere_aam, cone_aam;
+	bool is_gpu_initialized, is_attributes_uploaded;
+	// positions in the attribute arrays
+	joint_array uploaded_pose;
 
 public:
 	hand() 
+		: stats(nullptr), use_flex(true),
+		is_gpu_initialized(false), is_attributes_uploaded(false)
 	{}
 
-	hand(NDAPISpace::Location location, mat3 a_palm_ref)
-		: current_pulse(NONE)
+	// device_index is the glove's index in dm and becomes the hand's index
+	hand(const device_manager& dm, int device_index, mat3 a_palm_ref, latency_stats* a_stats = nullptr)
+		: index(device_index), stats(a_stats), use_flex(true),
+		is_gpu_initialized(false), is_attributes_uploaded(false)
 	{
-		device = nd_device(location);
+		device = nd_device(dm, device_index, stats);
 		init(a_palm_ref);
 	}
 
@@ -139,30 +123,49 @@ public:
 
 	void init(mat3 a_palm_ref);
 
-	void update_and_draw(cgv::render::context& ctx, const conn_panel& cp, vec3 pos, mat3 ori);
+	// takes this tick's glove snapshot, must precede update()
+	void update_glove() { glove = device.snapshot(); }
+
+	// glove state of the current tick, e.g. to filter its rotations
+	glove_snapshot& get_glove() { return glove; }
+
+	// one simulation tick: pose, containment and actuators
+	// pose_time is the arrival of the tracker pose, display_time the expected time the pose is shown
+	void update(conn_panel& cp, vec3 pos, mat3 ori,
+		chrono::steady_clock::time_point pose_time, chrono::steady_clock::time_point display_time);
+
+	// copies the pose of the last update() to s, s.pose_time is left to the caller
+	void publish(hand_state& s) const;
+
+	void set_pose_and_actuators(conn_panel& cp, vec3 position, quat orientation);
 
-	void set_pose_and_actuators(const conn_panel& cp, vec3 position, mat3 orientation);
+	// draws a published state, called on the render thread
+	void draw(context& ctx, const hand_state& s);
 
-	void draw(context& ctx);
+	// frees the attribute arrays, call before the context goes away
+	void clear(context& ctx);
 
-	void set_rotations(mat3 orientation);
+	void set_rotations(quat orientation);
 
 	int get_location() { return device.get_location(); }
 
+	int get_index() { return index; }
+
+	void set_use_flex(bool a_use_flex) { use_flex = a_use_flex; }
+
+	palm_fusion& get_fusion() { return fusion; }
+
 	void calibrate_to_mat(mat3 ref_mat);
 
 	void restore_last_calibration();
 
-	bool is_in_ack_pose() { return device.are_contacts_joined(NDAPISpace::CONT_THUMB, NDAPISpace::CONT_INDEX); }
-	bool is_in_decl_pose() { return device.are_contacts_joined(NDAPISpace::CONT_THUMB, NDAPISpace::CONT_MIDDLE); }
-	bool is_in_choice1_pose() { return device.are_contacts_joined(NDAPISpace::CONT_PALM, NDAPISpace::CONT_INDEX); }
-	bool is_in_choice2_pose() { return device.are_contacts_joined(NDAPISpace::CONT_PALM, NDAPISpace::CONT_MIDDLE); }
+	bool is_in_ack_pose() { return glove.is_joined(THUMB_INDEX); }
+	bool is_in_decl_pose() { return glove.is_joined(THUMB_MIDDLE); }
+	bool is_in_choice1_pose() { return glove.is_joined(PALM_INDEX); }
+	bool is_in_choice2_pose() { return glove.is_joined(PALM_MIDDLE); }
 
 	void set_ack_pulse();
 
+	// plays the whole pattern with one call, nothing is left to do per frame
 	void init_interactive_pulse(pulse_kind kind);
-
-	void deliver_interactive_pulse();
-
-	void reset_interactive_pulse();
 };
\ No newline at end of file
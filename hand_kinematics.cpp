@@ -0,0 +1,202 @@
+#include "hand_kinematics.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAND_KINEMATICS_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// v + 2w (u x v) + 2 u x (u x v) for unit q = (w, u)
+	inline vec3 rotate(const quat& q, const vec3& v)
+	{
+		vec3 u(q.x(), q.y(), q.z()),
+			t = 2.0f * cross(u, v);
+		return v + q.w() * t + cross(u, t);
+	}
+
+	// rotate() of (0, 0, -length), the direction every bone points in at rest
+	inline vec3 rotate_bone(const quat& q, float length)
+	{
+		float c = -length;
+		return vec3(
+			2 * c * (q.w() * q.y() + q.x() * q.z()),
+			2 * c * (q.y() * q.z() - q.w() * q.x()),
+			c * (1 - 2 * (q.x() * q.x() + q.y() * q.y())));
+	}
+}
+
+void forward_kinematics_scalar(const part_rotation_array& rotations,
+	const array<vec3, NUM_HAND_PARTS>& bone_lengths, const array<vec3, num_palm_joints>& palm_resting,
+	float scale, vec3 position, joint_array& joints)
+{
+	const quat& palm = rotations[PALM][0];
+	array<vec3, num_palm_joints> palm_joints;
+	for (int i = 0; i < num_palm_joints; i++)
+	{
+		palm_joints[i] = rotate(palm, palm_resting[i]);
+		joints[joint_index(PALM, i)] = scale * palm_joints[i] + position;
+	}
+
+	for (int finger = THUMB; finger < NUM_HAND_PARTS; finger++)
+	{
+		// rotation of the current bone relative to the hand and end of the previous one
+		quat chain(1, 0, 0, 0);
+		vec3 p = palm_joints[finger];
+		for (int bone = PROXIMAL; bone < NUM_BONES_PER_FINGER; bone++)
+		{
+			chain = chain * rotations[finger][bone];
+			p += rotate_bone(chain, bone_lengths[finger][bone]);
+			joints[joint_index(finger, bone)] = scale * p + position;
+		}
+	}
+}
+
+#ifdef HAND_KINEMATICS_SSE
+namespace
+{
+	const int simd_width = 4;
+
+	// four quaternions or vectors, one per lane
+	struct quat4 { __m128 w, x, y, z; };
+	struct vec4x3 { __m128 x, y, z; };
+
+	inline quat4 mul(const quat4& a, const quat4& b)
+	{
+		quat4 r;
+		r.w = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(a.w, b.w), _mm_mul_ps(a.x, b.x)), _mm_add_ps(_mm_mul_ps(a.y, b.y), _mm_mul_ps(a.z, b.z)));
+		r.x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.w, b.x), _mm_mul_ps(a.x, b.w)), _mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(a.z, b.y)));
+		r.y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.w, b.y), _mm_mul_ps(a.y, b.w)), _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)));
+		r.z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.w, b.z), _mm_mul_ps(a.z, b.w)), _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x)));
+		return r;
+	}
+
+	// rotate_bone() in four lanes
+	inline vec4x3 rotate_bone(const quat4& q, __m128 length)
+	{
+		__m128 c = _mm_sub_ps(_mm_setzero_ps(), length),
+			two_c = _mm_add_ps(c, c),
+			xx_yy = _mm_add_ps(_mm_mul_ps(q.x, q.x), _mm_mul_ps(q.y, q.y));
+		vec4x3 r;
+		r.x = _mm_mul_ps(two_c, _mm_add_ps(_mm_mul_ps(q.w, q.y), _mm_mul_ps(q.x, q.z)));
+		r.y = _mm_mul_ps(two_c, _mm_sub_ps(_mm_mul_ps(q.y, q.z), _mm_mul_ps(q.w, q.x)));
+		r.z = _mm_mul_ps(c, _mm_sub_ps(_mm_set1_ps(1.0f), _mm_add_ps(xx_yy, xx_yy)));
+		return r;
+	}
+
+	// rotate() of four vectors by the same quaternion
+	inline vec4x3 rotate(const quat& q, const vec4x3& v)
+	{
+		__m128 qw = _mm_set1_ps(q.w()), qx = _mm_set1_ps(q.x()), qy = _mm_set1_ps(q.y()), qz = _mm_set1_ps(q.z()),
+			two = _mm_set1_ps(2.0f);
+		// t = 2 u x v
+		__m128 tx = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(qy, v.z), _mm_mul_ps(qz, v.y))),
+			ty = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(qz, v.x), _mm_mul_ps(qx, v.z))),
+			tz = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(qx, v.y), _mm_mul_ps(qy, v.x)));
+		// v + w t + u x t
+		vec4x3 r;
+		r.x = _mm_add_ps(_mm_add_ps(v.x, _mm_mul_ps(qw, tx)), _mm_sub_ps(_mm_mul_ps(qy, tz), _mm_mul_ps(qz, ty)));
+		r.y = _mm_add_ps(_mm_add_ps(v.y, _mm_mul_ps(qw, ty)), _mm_sub_ps(_mm_mul_ps(qz, tx), _mm_mul_ps(qx, tz)));
+		r.z = _mm_add_ps(_mm_add_ps(v.z, _mm_mul_ps(qw, tz)), _mm_sub_ps(_mm_mul_ps(qx, ty), _mm_mul_ps(qy, tx)));
+		return r;
+	}
+
+	// scale * v + position, written to the joints at indices
+	inline void store(const vec4x3& v, __m128 scale, vec3 position, joint_array& joints, const int* indices, int num)
+	{
+		alignas(16) float x[simd_width], y[simd_width], z[simd_width];
+		_mm_store_ps(x, _mm_add_ps(_mm_mul_ps(scale, v.x), _mm_set1_ps(position.x())));
+		_mm_store_ps(y, _mm_add_ps(_mm_mul_ps(scale, v.y), _mm_set1_ps(position.y())));
+		_mm_store_ps(z, _mm_add_ps(_mm_mul_ps(scale, v.z), _mm_set1_ps(position.z())));
+		for (int i = 0; i < num; i++)
+		{
+			joints[indices[i]] = vec3(x[i], y[i], z[i]);
+		}
+	}
+}
+
+void forward_kinematics(const part_rotation_array& rotations,
+	const array<vec3, NUM_HAND_PARTS>& bone_lengths, const array<vec3, num_palm_joints>& palm_resting,
+	float scale, vec3 position, joint_array& joints)
+{
+	const quat& palm = rotations[PALM][0];
+	__m128 scale4 = _mm_set1_ps(scale);
+
+	// palm joints, four per step
+	alignas(16) float px[num_palm_joints], py[num_palm_joints], pz[num_palm_joints];
+	for (int i = 0; i < num_palm_joints; i++)
+	{
+		px[i] = palm_resting[i].x();
+		py[i] = palm_resting[i].y();
+		pz[i] = palm_resting[i].z();
+	}
+	for (int i = 0; i < num_palm_joints; i += simd_width)
+	{
+		vec4x3 v = { _mm_load_ps(px + i), _mm_load_ps(py + i), _mm_load_ps(pz + i) };
+		v = rotate(palm, v);
+		_mm_store_ps(px + i, v.x);
+		_mm_store_ps(py + i, v.y);
+		_mm_store_ps(pz + i, v.z);
+
+		int indices[simd_width] = { i, i + 1, i + 2, i + 3 };
+		store(v, scale4, position, joints, indices, simd_width);
+	}
+
+	// fingers, one per lane, unused lanes bend an empty finger
+	for (int first = THUMB; first < NUM_HAND_PARTS; first += simd_width)
+	{
+		int num = min(simd_width, NUM_HAND_PARTS - first);
+		alignas(16) float qw[NUM_BONES_PER_FINGER][simd_width], qx[NUM_BONES_PER_FINGER][simd_width],
+			qy[NUM_BONES_PER_FINGER][simd_width], qz[NUM_BONES_PER_FINGER][simd_width],
+			lengths[NUM_BONES_PER_FINGER][simd_width],
+			bx[simd_width] = { 0 }, by[simd_width] = { 0 }, bz[simd_width] = { 0 };
+		for (int lane = 0; lane < simd_width; lane++)
+		{
+			int finger = first + lane;
+			for (int bone = PROXIMAL; bone < NUM_BONES_PER_FINGER; bone++)
+			{
+				quat q = lane < num ? rotations[finger][bone] : quat(1, 0, 0, 0);
+				qw[bone][lane] = q.w();
+				qx[bone][lane] = q.x();
+				qy[bone][lane] = q.y();
+				qz[bone][lane] = q.z();
+				lengths[bone][lane] = lane < num ? bone_lengths[finger][bone] : .0f;
+			}
+			if (lane < num)
+			{
+				bx[lane] = px[finger];
+				by[lane] = py[finger];
+				bz[lane] = pz[finger];
+			}
+		}
+
+		quat4 chain = { _mm_set1_ps(1.0f), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+		vec4x3 p = { _mm_load_ps(bx), _mm_load_ps(by), _mm_load_ps(bz) };
+		for (int bone = PROXIMAL; bone < NUM_BONES_PER_FINGER; bone++)
+		{
+			quat4 q = { _mm_load_ps(qw[bone]), _mm_load_ps(qx[bone]), _mm_load_ps(qy[bone]), _mm_load_ps(qz[bone]) };
+			chain = mul(chain, q);
+			vec4x3 d = rotate_bone(chain, _mm_load_ps(lengths[bone]));
+			p.x = _mm_add_ps(p.x, d.x);
+			p.y = _mm_add_ps(p.y, d.y);
+			p.z = _mm_add_ps(p.z, d.z);
+
+			int indices[simd_width];
+			for (int lane = 0; lane < num; lane++)
+			{
+				indices[lane] = joint_index(first + lane, bone);
+			}
+			store(p, scale4, position, joints, indices, num);
+		}
+	}
+}
+#else
+void forward_kinematics(const part_rotation_array& rotations,
+	const array<vec3, NUM_HAND_PARTS>& bone_lengths, const array<vec3, num_palm_joints>& palm_resting,
+	float scale, vec3 position, joint_array& joints)
+{
+	forward_kinematics_scalar(rotations, bone_lengths, palm_resting, scale, position, joints);
+}
+#endif
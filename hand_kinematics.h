@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+
+#include "nd_device.h"
+#include "hand_layout.h"
+
+using namespace std;
+
+// rotations of the skeleton's bones
+// the palm's is at [PALM][0], each phalanx's is relative to its parent
+typedef array<array<quat, NUM_BONES_PER_FINGER>, NUM_HAND_PARTS> part_rotation_array;
+// joint positions laid out as in hand_layout.h
+typedef array<vec3, num_joints> joint_array;
+
+// forward kinematics of the hand skeleton
+// composes each finger's rotations once per bone and places the joint at the end
+// of the bone along -z, then scales and translates all joints in the same pass
+// bone_lengths[finger] holds the proximal, intermediate and distal length,
+// palm_resting the palm joints before the palm rotation
+// fingers are processed four at a time with SSE where available
+void forward_kinematics(const part_rotation_array& rotations,
+	const array<vec3, NUM_HAND_PARTS>& bone_lengths, const array<vec3, num_palm_joints>& palm_resting,
+	float scale, vec3 position, joint_array& joints);
+
+// same result without SIMD
+void forward_kinematics_scalar(const part_rotation_array& rotations,
+	const array<vec3, NUM_HAND_PARTS>& bone_lengths, const array<vec3, num_palm_joints>& palm_resting,
+	float scale, vec3 position, joint_array& joints);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "NDAPI.h"
+
+// anatomy of the hand skeleton and the layout of its flat joint array
+// all tables are known at compile time
+
+enum hand_parts
+{
+	PALM, THUMB, INDEX, MIDDLE, RING, PINKY, NUM_HAND_PARTS
+};
+
+enum phalanges
+{
+	PROXIMAL, INTERMED, DISTAL, NUM_BONES_PER_FINGER
+};
+
+// palm joints: center, finger bases from thumb to pinky (at the finger's part index),
+// two on the heel of the hand
+const int num_palm_joints = 8;
+const int num_fingers = NUM_HAND_PARTS - 1;
+// palm joints first, then each finger from proximal to distal
+const int num_joints = num_palm_joints + num_fingers * NUM_BONES_PER_FINGER;
+
+// index in the joint array, palm joints are addressed by their slot as phalanx
+constexpr int joint_index(int part, int phalanx)
+{
+	return part == PALM ? phalanx : num_palm_joints + (part - THUMB) * NUM_BONES_PER_FINGER + phalanx;
+}
+
+// range of a part's joints in the joint array
+constexpr int part_begin(int part) { return joint_index(part, 0); }
+constexpr int part_end(int part) { return part == PALM ? num_palm_joints : part_begin(part) + NUM_BONES_PER_FINGER; }
+
+// part and phalanx of each joint
+constexpr int joint_parts[num_joints] = {
+	PALM, PALM, PALM, PALM, PALM, PALM, PALM, PALM,
+	THUMB, THUMB, THUMB,
+	INDEX, INDEX, INDEX,
+	MIDDLE, MIDDLE, MIDDLE,
+	RING, RING, RING,
+	PINKY, PINKY, PINKY
+};
+constexpr int joint_phalanges[num_joints] = {
+	0, 1, 2, 3, 4, 5, 6, 7,
+	PROXIMAL, INTERMED, DISTAL,
+	PROXIMAL, INTERMED, DISTAL,
+	PROXIMAL, INTERMED, DISTAL,
+	PROXIMAL, INTERMED, DISTAL,
+	PROXIMAL, INTERMED, DISTAL
+};
+
+// actuator under each joint, -1 if there is none
+constexpr int joint_actuators[num_joints] = {
+	// palm: center, thumb base, index base, middle base, ring base, pinky base, heel
+	-1, -1, NDAPISpace::ACT_PALM_INDEX_UP, NDAPISpace::ACT_PALM_MIDDLE_UP, -1, NDAPISpace::ACT_PALM_PINKY_UP,
+	NDAPISpace::ACT_PALM_INDEX_DOWN, NDAPISpace::ACT_PALM_PINKY_DOWN,
+	// fingertips
+	-1, -1, NDAPISpace::ACT_THUMB,
+	-1, -1, NDAPISpace::ACT_INDEX,
+	-1, -1, NDAPISpace::ACT_MIDDLE,
+	-1, -1, NDAPISpace::ACT_RING,
+	-1, -1, NDAPISpace::ACT_PINKY
+};
+
+// pairs of joints connected by a cone
+const int num_cone_indices = 42;
+constexpr unsigned cone_indices[num_cone_indices] = {
+	// palm
+	2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 2,
+	// thumb
+	7, 8, 8, 9, 9, 10,
+	// index
+	2, 11, 11, 12, 12, 13,
+	// middle
+	3, 14, 14, 15, 15, 16,
+	// ring
+	4, 17, 17, 18, 18, 19,
+	// pinky
+	5, 20, 20, 21, 21, 22
+};
+
+static_assert(joint_index(PINKY, DISTAL) == num_joints - 1, "joint layout does not match num_joints");
@@ -0,0 +1,43 @@
+#include "haptic_library.h"
+
+void haptic_library::add_frame(haptic_sensation& s, const vector<NDAPISpace::Actuator>& actuators, float level) const
+{
+	size_t begin = s.values.size();
+	s.values.resize(begin + max_num_actuators, .0f);
+	for (auto act : actuators)
+	{
+		s.values[begin + act] = level;
+	}
+}
+
+void haptic_library::compile(const vector<NDAPISpace::Actuator>& actuators)
+{
+	const vector<NDAPISpace::Actuator> none;
+	for (size_t i = 0; i < NUM_SENSATIONS; i++)
+	{
+		sensations[i] = haptic_sensation();
+		sensations[i].delay_ms = frame_ms;
+	}
+
+	// ack: one frame on all actuators
+	haptic_sensation& ack = sensations[SENSATION_ACK];
+	add_frame(ack, actuators, .1f);
+	add_frame(ack, none, .0f);
+
+	// done: each actuator for one frame, one after the other
+	haptic_sensation& done = sensations[SENSATION_DONE];
+	for (auto act : actuators)
+	{
+		add_frame(done, vector<NDAPISpace::Actuator>(1, act), .5f);
+	}
+	add_frame(done, none, .0f);
+
+	// abort: three frames on all actuators with a frame of silence in between
+	const int num_abort_pulses = 3;
+	haptic_sensation& abort = sensations[SENSATION_ABORT];
+	for (size_t i = 0; i < num_abort_pulses; i++)
+	{
+		add_frame(abort, actuators, .3f);
+		add_frame(abort, none, .0f);
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include "glove_backend.h"
+
+using namespace std;
+
+enum sensation_kind
+{
+	// short buzz of all actuators
+	SENSATION_ACK,
+	// one actuator after the other
+	SENSATION_DONE,
+	// three buzzes of all actuators
+	SENSATION_ABORT,
+	NUM_SENSATIONS
+};
+
+// actuator timeline played by haptic_scheduler::play():
+// frame-major, max_num_actuators levels per frame (indexed by NDAPISpace::Actuator),
+// consecutive frames delay_ms apart, the last frame stops all actuators
+struct haptic_sensation
+{
+	vector<float> values;
+	int delay_ms;
+
+	int get_num_frames() const { return values.size() / max_num_actuators; }
+};
+
+// interaction feedback compiled once into sensations
+// the scheduler turns each into timed actuator events
+class haptic_library
+{
+	haptic_sensation sensations[NUM_SENSATIONS];
+
+	// time resolution of all sensations, pulses start and end on frames
+	const int frame_ms = 100;
+
+	// adds a frame with level on the given actuators and 0 on the others
+	void add_frame(haptic_sensation& s, const vector<NDAPISpace::Actuator>& actuators, float level) const;
+
+public:
+	// actuators in the order the DONE sensation runs through them
+	void compile(const vector<NDAPISpace::Actuator>& actuators);
+
+	const haptic_sensation& get(sensation_kind kind) const { return sensations[kind]; }
+};
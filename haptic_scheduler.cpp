@@ -0,0 +1,325 @@
+#include "haptic_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+haptic_scheduler::haptic_scheduler(glove_backend* a_backend, int a_device_id, latency_stats* a_stats)
+	: backend(a_backend), device_id(a_device_id), stats(a_stats), has_new_events(false), next_sequence(0),
+	is_running(false)
+{
+	for (size_t c = 0; c < NUM_HAPTIC_CHANNELS; c++)
+	{
+		for (size_t i = 0; i < max_num_actuators; i++)
+		{
+			levels[c][i] = 0;
+		}
+	}
+	for (size_t i = 0; i < max_num_actuators; i++)
+	{
+		sent_levels[i] = 0;
+		contact_targets[i] = 0;
+		contact_levels[i] = 0;
+	}
+}
+
+void haptic_scheduler::start()
+{
+	if (is_running)
+	{
+		return;
+	}
+
+	is_running = true;
+	worker = thread(&haptic_scheduler::run, this);
+}
+
+void haptic_scheduler::stop()
+{
+	{
+		lock_guard<mutex> lock(events_mutex);
+		is_running = false;
+	}
+	wake.notify_one();
+	if (worker.joinable())
+	{
+		worker.join();
+	}
+}
+
+void haptic_scheduler::schedule(const haptic_event* new_events, size_t num)
+{
+	if (num == 0)
+	{
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(events_mutex);
+		for (size_t i = 0; i < num; i++)
+		{
+			haptic_event e = new_events[i];
+			e.sequence = next_sequence++;
+			events.push(e);
+		}
+		has_new_events = true;
+	}
+	wake.notify_one();
+}
+
+void haptic_scheduler::schedule(haptic_channel channel, NDAPISpace::Actuator act, float level, float duration_ms,
+	chrono::steady_clock::time_point start, chrono::steady_clock::time_point cause)
+{
+	haptic_event e;
+	e.time = start;
+	e.end = start + chrono::microseconds((long long)(1000 * duration_ms));
+	e.cause = cause;
+	e.channel = channel;
+	e.actuator = act;
+	e.level = level;
+	schedule(&e, 1);
+}
+
+void haptic_scheduler::play(haptic_channel channel, const haptic_sensation& s, chrono::steady_clock::time_point start)
+{
+	int num_frames = s.get_num_frames();
+	// silence at the end needs no events, the holds of the last pulse just run out
+	while (num_frames > 0)
+	{
+		const float* last = s.values.data() + (num_frames - 1) * max_num_actuators;
+		if (any_of(last, last + max_num_actuators, [](float level) { return level > 0; }))
+		{
+			break;
+		}
+		num_frames--;
+	}
+
+	vector<haptic_event> frames;
+	frames.reserve(num_frames * max_num_actuators);
+	chrono::milliseconds delay(s.delay_ms);
+	for (int f = 0; f < num_frames; f++)
+	{
+		haptic_event e;
+		e.time = start + f * delay;
+		e.end = e.time + delay;
+		e.channel = channel;
+		for (int act = 0; act < max_num_actuators; act++)
+		{
+			e.actuator = act;
+			e.level = s.values[f * max_num_actuators + act];
+			frames.push_back(e);
+		}
+	}
+	schedule(frames.data(), frames.size());
+}
+
+void haptic_scheduler::cancel(haptic_channel channel)
+{
+	{
+		lock_guard<mutex> lock(events_mutex);
+		vector<haptic_event> kept;
+		while (!events.empty())
+		{
+			if (events.top().channel != channel)
+			{
+				kept.push_back(events.top());
+			}
+			events.pop();
+		}
+		for (auto& e : kept)
+		{
+			events.push(e);
+		}
+
+		haptic_event release;
+		release.time = chrono::steady_clock::now();
+		release.end = release.time;
+		release.channel = channel;
+		release.actuator = -1;
+		release.level = 0;
+		release.sequence = next_sequence++;
+		events.push(release);
+		has_new_events = true;
+	}
+	wake.notify_one();
+}
+
+void haptic_scheduler::set_contact_levels(const float* levels, chrono::steady_clock::time_point cause)
+{
+	bool has_changed = false;
+	{
+		lock_guard<mutex> lock(events_mutex);
+		for (size_t i = 0; i < max_num_actuators; i++)
+		{
+			if (levels[i] > 0 && contact_targets[i] <= 0)
+			{
+				contact_causes[i] = cause;
+			}
+			has_changed |= levels[i] != contact_targets[i];
+			contact_targets[i] = levels[i];
+		}
+		contact_update = chrono::steady_clock::now();
+		// unchanged targets need no wake-up, the worker already follows them
+		has_new_events |= has_changed;
+	}
+	if (has_changed)
+	{
+		wake.notify_one();
+	}
+}
+
+void haptic_scheduler::run()
+{
+	unique_lock<mutex> lock(events_mutex);
+	while (is_running)
+	{
+		// events due at the same time go out in one call
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		while (!events.empty() && events.top().time <= now)
+		{
+			apply(events.top());
+			events.pop();
+		}
+		has_new_events = false;
+		bool is_rendering = render_contacts(now);
+
+		// NDAPI calls without the lock, producers never wait for the driver
+		lock.unlock();
+		chrono::steady_clock::time_point next_change = min(send(now), now + (is_rendering ? render_period : idle_period));
+		lock.lock();
+
+		if (!events.empty())
+		{
+			next_change = min(next_change, events.top().time);
+		}
+		wake.wait_until(lock, next_change, [this] { return has_new_events || !is_running; });
+	}
+}
+
+void haptic_scheduler::apply(const haptic_event& e)
+{
+	if (e.actuator < 0)
+	{
+		for (size_t i = 0; i < max_num_actuators; i++)
+		{
+			ends[e.channel][i] = chrono::steady_clock::time_point();
+			levels[e.channel][i] = 0;
+		}
+		return;
+	}
+
+	int act = e.actuator;
+	if (ends[e.channel][act] > e.time)
+	{
+		levels[e.channel][act] = max(levels[e.channel][act], e.level);
+		ends[e.channel][act] = max(ends[e.channel][act], e.end);
+	}
+	else
+	{
+		levels[e.channel][act] = e.level;
+		ends[e.channel][act] = e.end;
+	}
+
+	bool has_cause = causes[act] != chrono::steady_clock::time_point();
+	if (e.cause != chrono::steady_clock::time_point() && (!has_cause || e.cause < causes[act]))
+	{
+		causes[act] = e.cause;
+	}
+}
+
+bool haptic_scheduler::render_contacts(chrono::steady_clock::time_point now)
+{
+	float dt_ms = chrono::duration<float, milli>(now - last_render).count();
+	last_render = now;
+	// first-order follower, exact for any step so late wake-ups do not overshoot
+	float alpha = 1.0f - exp(-max(dt_ms, .0f) / contact_time_constant_ms);
+	bool is_stale = now - contact_update > contact_timeout, is_active = false;
+	for (size_t i = 0; i < max_num_actuators; i++)
+	{
+		float target = is_stale ? .0f : contact_targets[i];
+		if (contact_causes[i] != chrono::steady_clock::time_point())
+		{
+			if (causes[i] == chrono::steady_clock::time_point() || contact_causes[i] < causes[i])
+			{
+				causes[i] = contact_causes[i];
+			}
+			contact_causes[i] = chrono::steady_clock::time_point();
+		}
+
+		contact_levels[i] += alpha * (target - contact_levels[i]);
+		if (abs(target - contact_levels[i]) < .5f * level_resolution)
+		{
+			contact_levels[i] = target;
+		}
+		is_active |= contact_levels[i] > 0 || target > 0;
+	}
+
+	return is_active;
+}
+
+chrono::steady_clock::time_point haptic_scheduler::send(chrono::steady_clock::time_point now)
+{
+	chrono::steady_clock::time_point next_change = chrono::steady_clock::time_point::max();
+	float new_levels[max_num_actuators];
+	bool has_changed = false, is_any_running = false;
+	for (size_t i = 0; i < max_num_actuators; i++)
+	{
+		// the first channel still holding the actuator decides its level,
+		// contacts hold an actuator while their level is above 0
+		new_levels[i] = 0;
+		for (size_t c = 0; c < NUM_HAPTIC_CHANNELS; c++)
+		{
+			bool is_held = ends[c][i] > now;
+			float level = is_held ? levels[c][i] : .0f;
+			if (c == HAPTIC_CONTACT && contact_levels[i] > 0)
+			{
+				is_held = true;
+				level = max(level, contact_levels[i]);
+			}
+			if (is_held)
+			{
+				new_levels[i] = level;
+				if (ends[c][i] > now)
+				{
+					next_change = min(next_change, ends[c][i]);
+				}
+				break;
+			}
+		}
+		// starting and stopping are always sent, small steps in between are not
+		has_changed |= abs(new_levels[i] - sent_levels[i]) >= level_resolution
+			|| (new_levels[i] > 0) != (sent_levels[i] > 0);
+		is_any_running |= new_levels[i] > 0;
+	}
+
+	if (!has_changed)
+	{
+		// events that only extend a running pulse send nothing to measure
+		for (size_t i = 0; i < max_num_actuators; i++)
+		{
+			causes[i] = chrono::steady_clock::time_point();
+		}
+		return next_change;
+	}
+
+	if (is_any_running)
+	{
+		backend->set_actuators_state(new_levels, max_num_actuators, device_id);
+	}
+	else
+	{
+		backend->set_actuators_stop(device_id);
+	}
+
+	chrono::steady_clock::time_point sent = chrono::steady_clock::now();
+	for (size_t i = 0; i < max_num_actuators; i++)
+	{
+		if (stats && new_levels[i] > 0 && sent_levels[i] <= 0)
+		{
+			stats->record(TOUCH_TO_HAPTIC, causes[i], sent);
+		}
+		causes[i] = chrono::steady_clock::time_point();
+		sent_levels[i] = new_levels[i];
+	}
+
+	return next_change;
+}
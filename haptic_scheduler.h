@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "glove_backend.h"
+#include "haptic_library.h"
+#include "latency_stats.h"
+
+using namespace std;
+
+// sources of actuator levels, in order of priority
+// on each actuator the highest priority channel holding it decides the level
+enum haptic_channel
+{
+	// ACK, DONE and ABORT, a running sensation masks touches
+	HAPTIC_INTERACTIVE,
+	// touches of panel elements, rendered continuously from set_contact_levels()
+	HAPTIC_CONTACT,
+	// patterns played by applications
+	HAPTIC_CUSTOM,
+	NUM_HAPTIC_CHANNELS
+};
+
+// holds level on one actuator of a channel from time to end
+struct haptic_event
+{
+	chrono::steady_clock::time_point time, end;
+	// time of the event that triggered the pulse, e.g. a touch, unset if unknown
+	chrono::steady_clock::time_point cause;
+	haptic_channel channel;
+	// NDAPISpace::Actuator, -1 releases all actuators of the channel
+	int actuator;
+	float level;
+	// order of queueing, set by haptic_scheduler
+	unsigned long long sequence;
+
+	// earliest first, on ties the higher priority channel first,
+	// then the one queued first, e.g. cancel()'s release before a following play()
+	bool operator>(const haptic_event& e) const
+	{
+		if (time != e.time)
+		{
+			return time > e.time;
+		}
+		if (channel != e.channel)
+		{
+			return channel > e.channel;
+		}
+		return sequence > e.sequence;
+	}
+};
+
+// plays timed actuator events of one glove on a thread of its own
+// so that pulses start and end on time whatever the frame or tick rate
+class haptic_scheduler
+{
+	glove_backend* backend;
+	int device_id;
+	// receives touch-to-haptic latencies, may be nullptr
+	latency_stats* stats;
+
+	// pending events, guarded by events_mutex
+	priority_queue<haptic_event, vector<haptic_event>, greater<haptic_event>> events;
+	mutex events_mutex;
+	condition_variable wake;
+	bool has_new_events;
+	// sequence of the next queued event, guarded by events_mutex
+	unsigned long long next_sequence;
+
+	// owned by the worker: level and end of each channel's hold per actuator
+	float levels[NUM_HAPTIC_CHANNELS][max_num_actuators];
+	chrono::steady_clock::time_point ends[NUM_HAPTIC_CHANNELS][max_num_actuators];
+	// time the earliest unsent event was caused, unset if there is none
+	chrono::steady_clock::time_point causes[max_num_actuators];
+	// levels the device currently runs at
+	float sent_levels[max_num_actuators];
+	// longest the worker sleeps without events
+	const chrono::milliseconds idle_period = chrono::milliseconds(100);
+
+	// continuous contact rendering
+	// newest levels from set_contact_levels() and their arrival, guarded by events_mutex
+	float contact_targets[max_num_actuators];
+	chrono::steady_clock::time_point contact_update;
+	chrono::steady_clock::time_point contact_causes[max_num_actuators];
+	// owned by the worker: levels approaching the targets and the time they were advanced
+	float contact_levels[max_num_actuators];
+	chrono::steady_clock::time_point last_render;
+	// rate the contact levels are advanced and streamed at while any is active
+	const chrono::microseconds render_period = chrono::microseconds(1000);
+	// time constant the levels follow their targets with
+	const float contact_time_constant_ms = 4.0f;
+	// targets fall to 0 if not updated for this long, e.g. when the simulation stalls
+	const chrono::milliseconds contact_timeout = chrono::milliseconds(50);
+	// smaller level changes are not sent
+	const float level_resolution = .01f;
+
+	atomic<bool> is_running;
+	thread worker;
+
+	void run();
+
+	// merges e into its channel's hold: while the actuator is held,
+	// the higher level and the later end win
+	void apply(const haptic_event& e);
+
+	// moves contact_levels toward the targets by the time since the last call
+	// must be called with events_mutex held, returns true while any contact is active
+	bool render_contacts(chrono::steady_clock::time_point now);
+
+	// sends the mixed levels of all channels if they changed by more than level_resolution
+	// returns the time the mix changes next without new events
+	chrono::steady_clock::time_point send(chrono::steady_clock::time_point now);
+
+public:
+	// a_device_id is the id within a_backend
+	haptic_scheduler(glove_backend* a_backend, int a_device_id, latency_stats* a_stats = nullptr);
+
+	~haptic_scheduler() { stop(); }
+
+	void start();
+
+	void stop();
+
+	// queues num events at once, the worker sees them together
+	void schedule(const haptic_event* new_events, size_t num);
+
+	// queues a pulse on one actuator starting at start
+	void schedule(haptic_channel channel, NDAPISpace::Actuator act, float level, float duration_ms,
+		chrono::steady_clock::time_point start, chrono::steady_clock::time_point cause = chrono::steady_clock::time_point());
+
+	// queues every frame of s on channel, the first at start
+	// each frame holds all actuators, trailing silent frames are left to the holds' ends
+	void play(haptic_channel channel, const haptic_sensation& s, chrono::steady_clock::time_point start);
+
+	// drops pending events of channel and releases its actuators
+	void cancel(haptic_channel channel);
+
+	// target level per actuator of the contact channel, max_num_actuators values
+	// called every simulation tick, the worker follows the targets at render_period
+	// cause is the time of the touch, used for latency statistics
+	void set_contact_levels(const float* levels, chrono::steady_clock::time_point cause);
+};
@@ -24,7 +24,9 @@ protected:
 	vector<vec2> extents;
 	vector<vec4> texture_ranges;
 	float scale;
-	bool is_visible;
+	// label 0 is the text, label 1 the status line below it
+	bool is_visible, is_status_visible;
+	string status;
 
 	plane_render_style prs;
 
@@ -35,28 +37,34 @@ protected:
 		lm.set_font_size(36);
 		lm.set_text_color(rgba(0, 0, 0, 1));
 		lm.add_label("init", rgba(1, 1, 1, .1f), 4, 4, 800, 90);
-
-		position.push_back(vec3(0));
-		orientation.push_back(quat(vec3(0, 1, 0), 0));
+		lm.add_label("status", rgba(1, .8f, .6f, .1f), 4, 4, 800, 90);
 
 		lm.pack_labels();
-		const auto& l = lm.get_label(0);
-		extents.push_back(scale * vec2(l.get_width(), l.get_height()));
-		texture_ranges.push_back(lm.get_texcoord_range(0));
+		for (int i = 0; i < lm.get_nr_labels(); i++)
+		{
+			position.push_back(vec3(0));
+			orientation.push_back(quat(vec3(0, 1, 0), 0));
+			const auto& l = lm.get_label(i);
+			extents.push_back(scale * vec2(l.get_width(), l.get_height()));
+			texture_ranges.push_back(lm.get_texcoord_range(i));
+		}
 	}
 
 	void set_pose(vec3 pos, mat3 ori)
 	{
-		vec3 vs_hmd = ori * vec3(.0f, .1f, -.6f);
+		vec3 vs_hmd = ori * vec3(.0f, .1f, -.6f),
+			status_vs_hmd = ori * vec3(.0f, .0f, -.6f);
 		position[0] = pos + vs_hmd;
 		orientation[0] = ori;
+		position[1] = pos + status_vs_hmd;
+		orientation[1] = ori;
 	}
 
 	void set_visible(bool a_visible = true) { is_visible = a_visible; }
 
 public:
 	headup_display()
-		: scale(.001f), is_visible(false)
+		: scale(.001f), is_visible(false), is_status_visible(false)
 	{
 		prs.illumination_mode = cgv::render::IM_OFF;
 		construct();
@@ -64,7 +72,7 @@ public:
 
 	void draw(context& ctx, vec3 p, mat3 ori)
 	{
-		if (!is_visible)
+		if (!is_visible && !is_status_visible)
 		{
 			return;
 		}
@@ -80,7 +88,7 @@ public:
 		if (rr.validate_and_enable(ctx))
 		{
 			lm.get_texture()->enable(ctx);
-			rr.draw(ctx, 0, lm.get_nr_labels());
+			rr.draw(ctx, is_visible ? 0 : 1, (is_visible ? 1 : 0) + (is_status_visible ? 1 : 0));
 			lm.get_texture()->disable(ctx);
 			rr.disable(ctx);
 		}
@@ -99,4 +107,21 @@ public:
 			set_visible(false);
 		}
 	}
+
+	// shown below the text, e.g. device warnings, hidden if empty
+	void set_status(string s)
+	{
+		if (s == status)
+		{
+			return;
+		}
+
+		status = s;
+		is_status_visible = !s.empty();
+		if (is_status_visible)
+		{
+			cout << "Headup display status: " << s << endl;
+			lm.update_label_text(1, s);
+		}
+	}
 };
\ No newline at end of file
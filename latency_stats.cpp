@@ -0,0 +1,135 @@
+#include "latency_stats.h"
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+
+void latency_histogram::reset()
+{
+	for (size_t i = 0; i < num_buckets; i++)
+	{
+		counts[i] = 0;
+	}
+	num_samples = 0;
+	sum_us = 0;
+	max_us = 0;
+}
+
+void latency_histogram::add(long long latency_us)
+{
+	latency_us = max(latency_us, 0LL);
+	counts[min(latency_us / bucket_width_us, (long long)num_buckets - 1)]++;
+	num_samples++;
+	sum_us += latency_us;
+	max_us = max(max_us, latency_us);
+}
+
+float latency_histogram::get_mean_ms() const
+{
+	return num_samples ? sum_us / (1000.0f * num_samples) : .0f;
+}
+
+float latency_histogram::get_percentile_ms(float p) const
+{
+	if (!num_samples)
+	{
+		return .0f;
+	}
+
+	long long rank = (long long)(p * num_samples), seen = 0;
+	for (size_t i = 0; i < num_buckets - 1; i++)
+	{
+		seen += counts[i];
+		if (seen > rank)
+		{
+			return (i + 1) * bucket_width_us / 1000.0f;
+		}
+	}
+
+	return get_max_ms();
+}
+
+const char* latency_stats::get_name(latency_kind kind)
+{
+	const char* names[] = { "sample_to_render", "pose_to_render", "touch_to_haptic" };
+	return names[kind];
+}
+
+void latency_stats::record(latency_kind kind, chrono::steady_clock::time_point from, chrono::steady_clock::time_point to)
+{
+	if (from == chrono::steady_clock::time_point())
+	{
+		return;
+	}
+
+	long long latency_us = chrono::duration_cast<chrono::microseconds>(to - from).count();
+	lock_guard<mutex> lock(hists_mutex);
+	hists[kind].add(latency_us);
+}
+
+latency_histogram latency_stats::get(latency_kind kind) const
+{
+	lock_guard<mutex> lock(hists_mutex);
+	return hists[kind];
+}
+
+void latency_stats::reset()
+{
+	lock_guard<mutex> lock(hists_mutex);
+	for (size_t i = 0; i < NUM_LATENCY_KINDS; i++)
+	{
+		hists[i].reset();
+	}
+}
+
+bool latency_stats::write_csv(const string& file_name) const
+{
+	latency_histogram copies[NUM_LATENCY_KINDS];
+	for (size_t i = 0; i < NUM_LATENCY_KINDS; i++)
+	{
+		copies[i] = get((latency_kind)i);
+	}
+
+	ofstream csv_file(file_name);
+	if (!csv_file.good())
+	{
+		cout << "Could not write " << file_name << "." << endl;
+		return false;
+	}
+
+	csv_file << "bucket_start_ms";
+	for (size_t i = 0; i < NUM_LATENCY_KINDS; i++)
+	{
+		csv_file << "," << get_name((latency_kind)i);
+	}
+	csv_file << endl;
+
+	for (size_t b = 0; b < latency_histogram::num_buckets; b++)
+	{
+		csv_file << b * latency_histogram::bucket_width_us / 1000.0f;
+		for (size_t i = 0; i < NUM_LATENCY_KINDS; i++)
+		{
+			csv_file << "," << copies[i].counts[b];
+		}
+		csv_file << endl;
+	}
+
+	csv_file.close();
+	return true;
+}
+
+string latency_stats::get_summary() const
+{
+	stringstream ss;
+	ss << fixed << setprecision(1);
+	for (size_t i = 0; i < NUM_LATENCY_KINDS; i++)
+	{
+		latency_histogram h = get((latency_kind)i);
+		ss << get_name((latency_kind)i) << ": mean " << h.get_mean_ms()
+			<< " ms, p99 " << h.get_percentile_ms(.99f)
+			<< " ms, max " << h.get_max_ms() << " ms" << endl;
+	}
+
+	return ss.str();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <fstream>
+
+using namespace std;
+
+enum latency_kind
+{
+	// glove sample taken -> hand drawn
+	SAMPLE_TO_RENDER,
+	// tracker pose event received -> hand drawn
+	POSE_TO_RENDER,
+	// touch detected by check_containments -> actuator command sent
+	TOUCH_TO_HAPTIC,
+	NUM_LATENCY_KINDS
+};
+
+// histogram of latencies with fixed bucket width
+// the last bucket collects everything above the range
+struct latency_histogram
+{
+	static const int num_buckets = 100;
+	// bucket i holds latencies in [i * bucket_width_us, (i + 1) * bucket_width_us)
+	static const long long bucket_width_us = 500;
+
+	long long counts[num_buckets];
+	long long num_samples, sum_us, max_us;
+
+	latency_histogram() { reset(); }
+
+	void reset();
+
+	void add(long long latency_us);
+
+	float get_mean_ms() const;
+
+	float get_max_ms() const { return max_us / 1000.0f; }
+
+	// upper bound of the bucket containing the p-th quantile, p in [0, 1]
+	float get_percentile_ms(float p) const;
+};
+
+// latencies of the whole pipeline, shared by all hands
+// recording and querying may happen on different threads
+class latency_stats
+{
+	mutable mutex hists_mutex;
+	latency_histogram hists[NUM_LATENCY_KINDS];
+
+public:
+	static const char* get_name(latency_kind kind);
+
+	// from is a monotonic timestamp, unset timestamps are ignored
+	void record(latency_kind kind, chrono::steady_clock::time_point from,
+		chrono::steady_clock::time_point to = chrono::steady_clock::now());
+
+	// copy, can be read while recording continues
+	latency_histogram get(latency_kind kind) const;
+
+	void reset();
+
+	// one row per bucket, one count column per kind
+	bool write_csv(const string& file_name) const;
+
+	// mean, 99th percentile and max per kind, e.g. for the head up display
+	string get_summary() const;
+};
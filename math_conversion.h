@@ -39,6 +39,30 @@ public:
 		return vec3(dir.x(), dir.y(), dir.z());
 	}
 
+	// splits q into swing * twist with twist about the x-axis
+	// returns the twist angle in (-pi, pi], one atan2 instead of a full Euler decomposition
+	// and no singularity when the swing approaches 90 degrees
+	static float swing_twist_x(const quat& q, quat& swing)
+	{
+		float w = q.w(), x = q.x();
+		if (w < 0)
+		{
+			w = -w;
+			x = -x;
+		}
+
+		float n = sqrt(w * w + x * x);
+		if (n < 1e-6f)
+		{
+			// swing by 180 degrees, the twist is undefined
+			swing = q;
+			return 0;
+		}
+
+		swing = q * quat(w / n, -x / n, 0, 0);
+		return 2 * atan2(x, w);
+	}
+
 	static vec3 ave_pos(const vr::vr_controller_state* ctrls)
 	{
 		vec3 result(0);
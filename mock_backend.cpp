@@ -0,0 +1,341 @@
+#include "mock_backend.h"
+
+#include <cmath>
+
+mock_backend::mock_backend(int num_gloves, float a_rate_hz)
+	: rate_hz(a_rate_hz), is_server_connected(false)
+{
+	gloves = vector<mock_glove>(num_gloves);
+	for (size_t i = 0; i < gloves.size(); i++)
+	{
+		gloves[i].location = i % 2 ? NDAPISpace::LOC_LEFT_HAND : NDAPISpace::LOC_RIGHT_HAND;
+		for (size_t act = 0; act < max_num_actuators; act++)
+		{
+			gloves[i].levels[act] = 0;
+		}
+	}
+	start = chrono::steady_clock::now();
+}
+
+void mock_backend::set_script(int device_id, const vector<mock_frame>& frames)
+{
+	if (is_valid(device_id))
+	{
+		gloves[device_id].script = frames;
+	}
+}
+
+void mock_backend::set_plugged(int device_id, bool is_plugged)
+{
+	if (is_valid(device_id))
+	{
+		gloves[device_id].is_plugged = is_plugged;
+	}
+}
+
+int mock_backend::get_num_actuator_calls(int device_id)
+{
+	lock_guard<mutex> lock(sink_mutex);
+	return is_valid(device_id) ? gloves[device_id].num_actuator_calls : NDAPISpace::ND_ERROR_INVALID_DEVICE;
+}
+
+void mock_backend::get_actuator_levels(float* levels, int device_id)
+{
+	lock_guard<mutex> lock(sink_mutex);
+	for (size_t act = 0; act < max_num_actuators; act++)
+	{
+		levels[act] = is_valid(device_id) ? gloves[device_id].levels[act] : .0f;
+	}
+}
+
+size_t mock_backend::get_frame_count() const
+{
+	chrono::duration<float> elapsed = chrono::steady_clock::now() - start;
+	return (size_t)(elapsed.count() * rate_hz);
+}
+
+void mock_backend::get_frame(mock_frame& frame, int device_id) const
+{
+	const vector<mock_frame>& script = gloves[device_id].script;
+	size_t frame_count = get_frame_count();
+	if (script.size())
+	{
+		frame = script[frame_count % script.size()];
+	}
+	else
+	{
+		make_synthetic_frame(frame, frame_count / rate_hz);
+	}
+}
+
+void mock_backend::make_synthetic_frame(mock_frame& frame, float t) const
+{
+	const float two_pi = 6.2831853f;
+	float curl = .5f * max_curl * (1 - cos(two_pi * t / curl_period_s));
+
+	for (size_t i = 0; i < max_num_imus; i++)
+	{
+		frame.rotations[i] = NDAPISpace::quaternion_t{ 0, 0, 0, 1 };
+	}
+	// fingers curl around x, the thumb swings around z
+	for (size_t i = NDAPISpace::IMULOC_INDEX; i <= NDAPISpace::IMULOC_PINKY; i++)
+	{
+		frame.rotations[i] = NDAPISpace::quaternion_t{ sin(.5f * curl), 0, 0, cos(.5f * curl) };
+	}
+	frame.rotations[NDAPISpace::IMULOC_THUMB0] = NDAPISpace::quaternion_t{ 0, 0, sin(.25f * curl), cos(.25f * curl) };
+	frame.rotations[NDAPISpace::IMULOC_THUMB1] = NDAPISpace::quaternion_t{ 0, 0, sin(.5f * curl), cos(.5f * curl) };
+	// flex sensors bend with the fingers
+	for (size_t i = 0; i < max_num_flex; i++)
+	{
+		frame.flex[i] = curl / max_curl;
+	}
+
+	// palm, thumb, index, middle
+	bool is_touching = fmod(t, contact_period_s) < contact_duration_s;
+	frame.contacts[0] = 0;
+	frame.contacts[1] = is_touching ? 1 : 0;
+	frame.contacts[2] = is_touching ? 1 : 0;
+	frame.contacts[3] = 0;
+}
+
+int mock_backend::connect_to_server()
+{
+	is_server_connected = true;
+	return 0;
+}
+
+int mock_backend::close_connection()
+{
+	is_server_connected = false;
+	return 0;
+}
+
+int mock_backend::get_number_of_devices()
+{
+	return is_server_connected ? (int)gloves.size() : (int)NDAPISpace::ND_ERROR_SERVICE_UNAVAILABLE;
+}
+
+int mock_backend::get_devices_id(int* ids, int num_ids)
+{
+	if (!is_server_connected)
+	{
+		return NDAPISpace::ND_ERROR_SERVICE_UNAVAILABLE;
+	}
+
+	int num = min(num_ids, (int)gloves.size());
+	for (int i = 0; i < num; i++)
+	{
+		ids[i] = i;
+	}
+
+	return num;
+}
+
+int mock_backend::get_device_location(int device_id)
+{
+	return is_valid(device_id) ? (int)gloves[device_id].location : NDAPISpace::ND_ERROR_INVALID_DEVICE;
+}
+
+int mock_backend::is_connected(int device_id)
+{
+	return is_valid(device_id) ? (int)gloves[device_id].is_plugged.load() : NDAPISpace::ND_ERROR_INVALID_DEVICE;
+}
+
+int mock_backend::get_connection_type(int device_id)
+{
+	if (!is_valid(device_id))
+	{
+		return NDAPISpace::ND_ERROR_INVALID_DEVICE;
+	}
+
+	return is_available(device_id) ? NDAPISpace::CONN_BLUETOOTH : NDAPISpace::CONN_DISCONNECTED;
+}
+
+int mock_backend::get_battery_level(float& level, int device_id)
+{
+	if (!is_valid(device_id))
+	{
+		return NDAPISpace::ND_ERROR_INVALID_DEVICE;
+	}
+	if (!is_available(device_id))
+	{
+		return NDAPISpace::ND_ERROR_DEVICE_NOT_CONNECTED;
+	}
+
+	float t = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+	level = max(1 - t / battery_life_s, .0f);
+
+	return 0;
+}
+
+int mock_backend::get_info(NDAPISpace::DriverInfo param, float& value, int device_id)
+{
+	if (!is_valid(device_id))
+	{
+		return NDAPISpace::ND_ERROR_INVALID_DEVICE;
+	}
+
+	switch (param)
+	{
+	case NDAPISpace::INFO_IMU_FPS:
+		value = rate_hz;
+		return 0;
+	default:
+		return NDAPISpace::ND_ERROR_INVALID_PARAMETER_ID;
+	}
+}
+
+int mock_backend::get_number_of_imus(int device_id)
+{
+	// palm, two on the thumb, one per finger
+	return is_valid(device_id) ? NDAPISpace::IMULOC_PINKY + 1 : NDAPISpace::ND_ERROR_INVALID_DEVICE;
+}
+
+int mock_backend::get_rotations(NDAPISpace::imu_sensor_t* imus, int num_imus, int device_id)
+{
+	if (!is_valid(device_id))
+	{
+		return NDAPISpace::ND_ERROR_INVALID_DEVICE;
+	}
+	if (!is_available(device_id))
+	{
+		return NDAPISpace::ND_ERROR_DEVICE_NOT_CONNECTED;
+	}
+
+	mock_frame frame;
+	get_frame(frame, device_id);
+	for (int i = 0; i < min(num_imus, max_num_imus); i++)
+	{
+		imus[i].location = (NDAPISpace::ImuLocation)i;
+		imus[i].rawRotation = frame.rotations[i];
+		imus[i].hasRotation = true;
+	}
+
+	return 0;
+}
+
+int mock_backend::get_palm_acceleration(NDAPISpace::vector3d_t& acceleration, int device_id)
+{
+	if (!is_valid(device_id))
+	{
+		return NDAPISpace::ND_ERROR_INVALID_DEVICE;
+	}
+	if (!is_available(device_id))
+	{
+		return NDAPISpace::ND_ERROR_DEVICE_NOT_CONNECTED;
+	}
+
+	// up in g (y in NDAPI coords) seen from the rotated palm: conj(q) * (0, 1, 0) * q
+	mock_frame frame;
+	get_frame(frame, device_id);
+	const NDAPISpace::quaternion_t& q = frame.rotations[NDAPISpace::IMULOC_PALM];
+	acceleration.x = 2 * (q.x * q.y + q.w * q.z);
+	acceleration.y = 1 - 2 * (q.x * q.x + q.z * q.z);
+	acceleration.z = 2 * (q.y * q.z - q.w * q.x);
+
+	return 0;
+}
+
+int mock_backend::get_number_of_contacts(int device_id)
+{
+	return is_valid(device_id) ? max_num_contacts : NDAPISpace::ND_ERROR_INVALID_DEVICE;
+}
+
+int mock_backend::get_contacts_state(int* values, int num_values, int device_id)
+{
+	if (!is_valid(device_id))
+	{
+		return NDAPISpace::ND_ERROR_INVALID_DEVICE;
+	}
+	if (!is_available(device_id))
+	{
+		return NDAPISpace::ND_ERROR_DEVICE_NOT_CONNECTED;
+	}
+
+	mock_frame frame;
+	get_frame(frame, device_id);
+	for (int i = 0; i < min(num_values, max_num_contacts); i++)
+	{
+		values[i] = frame.contacts[i];
+	}
+
+	return 0;
+}
+
+int mock_backend::get_number_of_flex(int device_id)
+{
+	return is_valid(device_id) ? max_num_flex : NDAPISpace::ND_ERROR_INVALID_DEVICE;
+}
+
+int mock_backend::get_flex_state(float* values, int num_values, int device_id)
+{
+	if (!is_valid(device_id))
+	{
+		return NDAPISpace::ND_ERROR_INVALID_DEVICE;
+	}
+	if (!is_available(device_id))
+	{
+		return NDAPISpace::ND_ERROR_DEVICE_NOT_CONNECTED;
+	}
+
+	mock_frame frame;
+	get_frame(frame, device_id);
+	for (int i = 0; i < min(num_values, max_num_flex); i++)
+	{
+		values[i] = frame.flex[i];
+	}
+
+	return 0;
+}
+
+int mock_backend::has_actuator(NDAPISpace::Actuator act, int device_id)
+{
+	if (!is_valid(device_id))
+	{
+		return NDAPISpace::ND_ERROR_INVALID_DEVICE;
+	}
+
+	return act >= 0 && act < max_num_actuators ? 1 : 0;
+}
+
+int mock_backend::set_actuators_state(const float* levels, int num_values, int device_id)
+{
+	if (!is_valid(device_id))
+	{
+		return NDAPISpace::ND_ERROR_INVALID_DEVICE;
+	}
+	if (!is_available(device_id))
+	{
+		return NDAPISpace::ND_ERROR_DEVICE_NOT_CONNECTED;
+	}
+
+	lock_guard<mutex> lock(sink_mutex);
+	for (int act = 0; act < min(num_values, max_num_actuators); act++)
+	{
+		gloves[device_id].levels[act] = levels[act];
+	}
+	gloves[device_id].num_actuator_calls++;
+
+	return 0;
+}
+
+int mock_backend::set_actuators_stop(int device_id)
+{
+	if (!is_valid(device_id))
+	{
+		return NDAPISpace::ND_ERROR_INVALID_DEVICE;
+	}
+	if (!is_available(device_id))
+	{
+		return NDAPISpace::ND_ERROR_DEVICE_NOT_CONNECTED;
+	}
+
+	lock_guard<mutex> lock(sink_mutex);
+	for (size_t act = 0; act < max_num_actuators; act++)
+	{
+		gloves[device_id].levels[act] = 0;
+	}
+	gloves[device_id].num_actuator_calls++;
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+
+#include "glove_backend.h"
+
+using namespace std;
+
+// one scripted step of a mock glove
+struct mock_frame
+{
+	NDAPISpace::quaternion_t rotations[max_num_imus];
+	// contact groups as reported by getContactsState(), 0 if not pressed
+	int contacts[max_num_contacts];
+	// bend per NDAPISpace::Flex, 0 open to 1 fully curled
+	float flex[max_num_flex];
+};
+
+// in-process stand-in for the NeuroDigital service
+// plays scripted frames or synthetic finger motion at a fixed rate
+// and records actuator commands instead of vibrating
+class mock_backend : public glove_backend
+{
+	struct mock_glove
+	{
+		NDAPISpace::Location location;
+		// played in a loop, synthetic motion if empty
+		vector<mock_frame> script;
+		// actuator sink
+		float levels[max_num_actuators];
+		int num_actuator_calls;
+		// unplugged gloves report ND_ERROR_DEVICE_NOT_CONNECTED
+		atomic<bool> is_plugged;
+
+		mock_glove()
+			: num_actuator_calls(0), is_plugged(true)
+		{}
+
+		mock_glove(const mock_glove& g)
+			: location(g.location), script(g.script), num_actuator_calls(g.num_actuator_calls),
+			is_plugged(g.is_plugged.load())
+		{
+			copy(g.levels, g.levels + max_num_actuators, levels);
+		}
+	};
+
+	// device id is the index
+	vector<mock_glove> gloves;
+	float rate_hz;
+	chrono::steady_clock::time_point start;
+	// set by the device_manager thread, read by the sampler and haptic threads
+	atomic<bool> is_server_connected;
+	mutex sink_mutex;
+
+	// synthetic motion: fingers curl and stretch, thumb and index touch periodically
+	const float curl_period_s = 2.0f, max_curl = 1.2f,
+		contact_period_s = 4.0f, contact_duration_s = 1.0f,
+		battery_life_s = 4 * 3600.0f;
+
+	bool is_valid(int device_id) const { return device_id >= 0 && device_id < (int)gloves.size(); }
+
+	// is_valid() and plugged in
+	bool is_available(int device_id) const { return is_valid(device_id) && gloves[device_id].is_plugged; }
+
+	// number of frames played since start
+	size_t get_frame_count() const;
+
+	void get_frame(mock_frame& frame, int device_id) const;
+
+	void make_synthetic_frame(mock_frame& frame, float t) const;
+
+public:
+	// gloves alternate between right and left hand, starting with the right
+	mock_backend(int num_gloves = 2, float a_rate_hz = 1000.0f);
+
+	// replaces synthetic motion, call before any device is sampled
+	void set_script(int device_id, const vector<mock_frame>& frames);
+
+	// simulates unplugging and replugging a glove
+	void set_plugged(int device_id, bool is_plugged);
+
+	// actuator sink
+	int get_num_actuator_calls(int device_id);
+	void get_actuator_levels(float* levels, int device_id);
+
+	// glove_backend
+	int connect_to_server() override;
+	int close_connection() override;
+	int get_number_of_devices() override;
+	int get_devices_id(int* ids, int num_ids) override;
+
+	int get_device_location(int device_id) override;
+	int is_connected(int device_id) override;
+	int get_info(NDAPISpace::DriverInfo param, float& value, int device_id) override;
+	// bluetooth while plugged
+	int get_connection_type(int device_id) override;
+	// drains from full in battery_life_s
+	int get_battery_level(float& level, int device_id) override;
+
+	int get_number_of_imus(int device_id) override;
+	int get_rotations(NDAPISpace::imu_sensor_t* imus, int num_imus, int device_id) override;
+	// gravity only, the mock palm never accelerates
+	int get_palm_acceleration(NDAPISpace::vector3d_t& acceleration, int device_id) override;
+	int get_number_of_contacts(int device_id) override;
+	int get_contacts_state(int* values, int num_values, int device_id) override;
+	int get_number_of_flex(int device_id) override;
+	int get_flex_state(float* values, int num_values, int device_id) override;
+
+	// mock gloves have every actuator
+	int has_actuator(NDAPISpace::Actuator act, int device_id) override;
+	int set_actuators_state(const float* levels, int num_values, int device_id) override;
+	int set_actuators_stop(int device_id) override;
+};
@@ -1,30 +1,52 @@
 #include "nd_device.h"
 
-inline vector<quat> nd_device::get_raw_cgv_rotations()
+glove_snapshot nd_device::snapshot()
 {
-	nd_handler& ndh = nd_handler::instance();
-	ndh.get_rotations(imu_vals, num_imus, id);
+	// every sample since the last snapshot feeds the palm readings,
+	// the newest one the rest of the snapshot
+	// keeps the previous sample if the sampler has not delivered a new one
+	glove_snapshot result;
+	glove_sample sample;
+	while (sampler->get_next(sample))
+	{
+		if (sample.has_palm_acceleration && result.num_palm_samples < max_num_palm_samples)
+		{
+			palm_sample& p = result.palm_samples[result.num_palm_samples++];
+			p.timestamp = sample.timestamp;
+			p.rotation = nd_to_cgv_quat(sample.imus[NDAPISpace::IMULOC_PALM].rawRotation);
+			p.acceleration = nd_to_cgv_vec(sample.palm_acceleration);
+		}
+		latest_sample = sample;
+	}
 
-	vector<quat> cgv_rotations;
-	NDAPISpace::quaternion_t nd_quat;
-	for (size_t i = 0; i < num_imus; i++)
+	result.timestamp = latest_sample.timestamp;
+	get_rel_cgv_rotations(result.rotations);
+	result.joined_contacts = latest_sample.joined_contacts;
+	result.has_flex = sampler->get_number_of_flex() == max_num_flex;
+	if (result.has_flex)
 	{
-		nd_quat = imu_vals[i].rawRotation;
-		cgv_rotations.push_back(nd_to_cgv_quat(nd_quat));
+		copy(latest_sample.flex, latest_sample.flex + max_num_flex, result.flex.begin());
 	}
+	result.location = location;
 
-	return cgv_rotations;
+	return result;
 }
 
-vector<quat> nd_device::get_rel_cgv_rotations()
+void nd_device::get_raw_cgv_rotations(imu_rotation_array& rotations) const
 {
-	vector<quat> rotations = get_raw_cgv_rotations();
-	for (size_t i = 0; i < num_imus; i++)
+	for (int i = 0; i < num_imus; i++)
 	{
-		rotations[i] = ref_quats[i] * rotations[i];
+		rotations[i] = nd_to_cgv_quat(latest_sample.imus[i].rawRotation);
 	}
+}
 
-	return rotations;
+void nd_device::get_rel_cgv_rotations(imu_rotation_array& rotations) const
+{
+	// conversion and calibration in one pass
+	for (int i = 0; i < num_imus; i++)
+	{
+		rotations[i] = ref_quats[i] * nd_to_cgv_quat(latest_sample.imus[i].rawRotation);
+	}
 }
 
 // set "new unit"
@@ -32,12 +54,6 @@ vector<quat> nd_device::get_rel_cgv_rotations()
 
 // converting quats from NDAPI to cgv space
 
-void nd_device::set_actuator_pulse(NDAPISpace::Actuator act, float level, float duration_ms)
-{
-	nd_handler& ndh = nd_handler::instance();
-	ndh.set_actuator_pulse(id, act, level, duration_ms);
-}
-
 quat nd_device::nd_to_cgv_quat(NDAPISpace::quaternion_t nd_q)
 {
 	if (nd_q.w || nd_q.x || nd_q.y || nd_q.z)
@@ -53,21 +69,11 @@ quat nd_device::nd_to_cgv_quat(NDAPISpace::quaternion_t nd_q)
 	}
 }
 
-int nd_device::get_location() {
-	nd_handler& ndh = nd_handler::instance();
-	return ndh.get_location(id);
-}
-
-bool nd_device::are_contacts_joined(NDAPISpace::Contact c1, NDAPISpace::Contact c2) {
-	nd_handler& ndh = nd_handler::instance();
-	return ndh.are_contacts_joined(c1, c2, id);
-}
-
 void nd_device::calibrate()
 {
 	prev_ref_quats = ref_quats;
-	ref_quats = get_raw_cgv_rotations();
-	for (size_t i = 0; i < num_imus; i++)
+	get_raw_cgv_rotations(ref_quats);
+	for (int i = 0; i < num_imus; i++)
 	{
 		ref_quats[i] = ref_quats[i].inverse();
 		ref_quats[i].normalize();
@@ -1,63 +1,152 @@
 #pragma once
 
 #include<cgv/render/render_types.h>
+#include <memory>
+#include <array>
 
-#include "nd_handler.h"
+#include "device_manager.h"
+#include "glove_sampler.h"
+#include "haptic_scheduler.h"
 
 using namespace std;
 typedef cgv::math::quaternion<float> quat;
 typedef cgv::render::render_types::vec3 vec3;
+// one rotation per IMU, indexed by NDAPISpace::ImuLocation
+typedef array<quat, max_num_imus> imu_rotation_array;
+
+// palm IMU reading in cgv space
+struct palm_sample
+{
+	chrono::steady_clock::time_point timestamp;
+	// raw, not relative to the calibration
+	quat rotation;
+	// in g including gravity, in the palm IMU's frame
+	vec3 acceleration;
+};
+
+// at most the number of samples the sampler can buffer between two frames
+const int max_num_palm_samples = 16;
+
+// everything a frame needs to know about a glove
+// taken once per frame by nd_device::snapshot()
+struct glove_snapshot
+{
+	// time the underlying sample was taken
+	chrono::steady_clock::time_point timestamp;
+	// IMU rotations relative to the calibration in cgv space
+	imu_rotation_array rotations;
+	// bit p is set if contact_pair p is joined
+	int joined_contacts;
+	// bend per NDAPISpace::Flex, only valid if has_flex
+	array<float, max_num_flex> flex;
+	bool has_flex;
+	// left or right hand
+	int location;
+	// palm readings since the previous snapshot, oldest first
+	array<palm_sample, max_num_palm_samples> palm_samples;
+	int num_palm_samples;
+
+	glove_snapshot()
+		: joined_contacts(0), has_flex(false), location(-1), num_palm_samples(0)
+	{
+		flex.fill(0);
+		// IMUs the device does not have stay identity
+		rotations.fill(quat(1, 0, 0, 0));
+	}
+
+	bool is_joined(contact_pair p) const { return (joined_contacts >> p) & 1; }
+};
 
 class nd_device
 {
 protected:
 	// left or right hand
 	NDAPISpace::Location location;
-	// ND internal ID and number of inertial sensors
+	// backend the glove belongs to, ID within the backend and number of inertial sensors
+	glove_backend* backend;
 	int id, num_imus;
+	// bit a is set if the glove has NDAPISpace::Actuator a
+	int actuator_mask;
 	
-	// needs to be array for get_rotations()
-	NDAPISpace::imu_sensor_t* imu_vals;
+	// polls the glove off the render thread
+	shared_ptr<glove_sampler> sampler;
+	// newest sample taken from sampler
+	glove_sample latest_sample;
+	// plays actuator events and renders contacts off the simulation thread
+	shared_ptr<haptic_scheduler> haptics;
 	// quats saved for calibration ("new unit quat")
-	vector<quat> ref_quats, prev_ref_quats;
+	imu_rotation_array ref_quats, prev_ref_quats;
 
 public:
-	nd_device() {};
+	nd_device() : actuator_mask(0) {};
 
-	nd_device(NDAPISpace::Location a_location)
+	// device is the index in dm, stats receives the actuators' latencies
+	nd_device(const device_manager& dm, int device, latency_stats* stats = nullptr)
 	{
-		nd_handler& ndh = nd_handler::instance();
-		id = ndh.get_device_id(a_location);
-		if (id < 0)
+		backend = dm.get_backend(device);
+		id = dm.get_backend_id(device);
+		location = dm.get_location(device);
+		num_imus = min(backend->get_number_of_imus(id), max_num_imus);
+		actuator_mask = 0;
+		for (int act = 0; act < max_num_actuators; act++)
 		{
-			"Error: could not find device.";
-			return;
+			if (backend->has_actuator((NDAPISpace::Actuator)act, id) == 1)
+			{
+				actuator_mask |= 1 << act;
+			}
 		}
 
-		location = a_location;
-		num_imus = ndh.get_number_of_imus(id);
+		latest_sample = glove_sample();
+		sampler = make_shared<glove_sampler>(backend, id, num_imus);
+		sampler->start();
 
-		imu_vals = new NDAPISpace::imu_sensor_t[num_imus];
+		haptics = make_shared<haptic_scheduler>(backend, id, stats);
+		haptics->start();
 
-		ref_quats = vector<quat>(num_imus, quat(1, 0, 0, 0));
+		ref_quats.fill(quat(1, 0, 0, 0));
 		prev_ref_quats = ref_quats;
 	}
 
-	vector<quat> get_raw_cgv_rotations();
+	// takes the newest sample and returns it as seen by this frame
+	// no NDAPI call is made, the sampler thread does all of them
+	glove_snapshot snapshot();
+
+	// rotations of the newest snapshot's sample
+	// writes the first num_imus entries of rotations, allocates nothing
+	void get_raw_cgv_rotations(imu_rotation_array& rotations) const;
 
 	// rotations relative to ref_quats
-	vector<quat> get_rel_cgv_rotations();
+	// writes the first num_imus entries of rotations, allocates nothing
+	void get_rel_cgv_rotations(imu_rotation_array& rotations) const;
 
 	bool is_left() { return location == NDAPISpace::LOC_LEFT_HAND; }
 
-	void set_actuator_pulse(NDAPISpace::Actuator act, float level = .1, float duration_ms = 100);
+	bool has_actuator(int act) const { return (actuator_mask >> act) & 1; }
+
+	// contact level per actuator, max_num_actuators values, 0 where nothing is touched
+	// cause is the time of the touch, used for latency statistics
+	void set_contact_levels(const float* levels, chrono::steady_clock::time_point cause)
+	{
+		if (haptics)
+		{
+			haptics->set_contact_levels(levels, cause);
+		}
+	}
+
+	// plays s on channel from now on, replacing what the channel still had to play
+	void play_sensation(const haptic_sensation& s, haptic_channel channel = HAPTIC_INTERACTIVE)
+	{
+		haptics->cancel(channel);
+		haptics->play(channel, s, chrono::steady_clock::now());
+	}
 
 	// converting quats from NDAPI to cgv space
 	static quat nd_to_cgv_quat(NDAPISpace::quaternion_t nd_q);
 
-	int get_location();
+	// converting vectors from NDAPI to cgv space, the counterpart of nd_to_cgv_quat
+	static vec3 nd_to_cgv_vec(NDAPISpace::vector3d_t nd_v) { return vec3(nd_v.x, nd_v.y, -nd_v.z); }
 
-	bool are_contacts_joined(NDAPISpace::Contact c1, NDAPISpace::Contact c2);
+	int get_location() { return location; }
 
 	// set "new unit"
 	void calibrate();
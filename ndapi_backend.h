@@ -0,0 +1,40 @@
+#pragma once
+
+#include <mutex>
+
+#include "glove_backend.h"
+
+using namespace std;
+
+// glove_backend talking to the NeuroDigital service
+// the sampler, haptic, telemetry and device_manager threads share one client,
+// every call holds nd_mutex so a reconnect never runs while another call is in flight
+class ndapi_backend : public glove_backend
+{
+	NDAPISpace::NDAPI nd;
+	mutex nd_mutex;
+
+public:
+	int connect_to_server() override { lock_guard<mutex> lock(nd_mutex); return nd.connectToServer(); }
+	int close_connection() override { lock_guard<mutex> lock(nd_mutex); return nd.closeConnection(); }
+	int get_number_of_devices() override { lock_guard<mutex> lock(nd_mutex); return nd.getNumberOfDevices(); }
+	int get_devices_id(int* ids, int num_ids) override { lock_guard<mutex> lock(nd_mutex); return nd.getDevicesId(ids, num_ids); }
+
+	int get_device_location(int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getDeviceLocation(device_id); }
+	int is_connected(int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.isConnected(device_id); }
+	int get_info(NDAPISpace::DriverInfo param, float& value, int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getInfo(param, value, device_id); }
+	int get_connection_type(int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getConnectionType(device_id); }
+	int get_battery_level(float& level, int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getBatteryLevel(level, device_id); }
+
+	int get_number_of_imus(int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getNumberOfImus(device_id); }
+	int get_rotations(NDAPISpace::imu_sensor_t* imus, int num_imus, int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getRotations(imus, num_imus, device_id); }
+	int get_palm_acceleration(NDAPISpace::vector3d_t& acceleration, int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getPalmAcceleration(acceleration, device_id); }
+	int get_number_of_contacts(int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getNumberOfContacts(device_id); }
+	int get_contacts_state(int* values, int num_values, int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getContactsState(values, num_values, device_id); }
+	int get_number_of_flex(int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getNumberOfFlex(device_id); }
+	int get_flex_state(float* values, int num_values, int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.getFlexState(values, num_values, device_id); }
+
+	int has_actuator(NDAPISpace::Actuator act, int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.hasActuator(act, device_id); }
+	int set_actuators_state(const float* levels, int num_values, int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.setActuatorsState(levels, num_values, device_id); }
+	int set_actuators_stop(int device_id) override { lock_guard<mutex> lock(nd_mutex); return nd.setActuatorsStop(device_id); }
+};
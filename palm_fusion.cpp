@@ -0,0 +1,116 @@
+#include "palm_fusion.h"
+
+#include <algorithm>
+
+palm_fusion::palm_fusion()
+	: position(0), velocity(0), orientation(1, 0, 0, 0), angular_velocity(0), last_imu_rotation(1, 0, 0, 0), has_imu(false), has_pose(false),
+	position_gain(.5f), velocity_gain(.1f), orientation_gain(.5f)
+{
+	world_to_model.identity();
+}
+
+void palm_fusion::correct(chrono::steady_clock::time_point t, vec3 tracker_position, quat tracker_orientation)
+{
+	if (t == chrono::steady_clock::time_point() || t == last_correction)
+	{
+		return;
+	}
+
+	// without IMU readings there is nothing to blend with
+	if (!has_pose || !has_imu)
+	{
+		position = tracker_position;
+		velocity = vec3(0);
+		orientation = tracker_orientation;
+		timestamp = t;
+		last_correction = t;
+		has_pose = true;
+		return;
+	}
+
+	// position error pulls position and, per elapsed time, velocity
+	vec3 error = tracker_position - position;
+	float dt = chrono::duration<float>(t - last_correction).count();
+	position += position_gain * error;
+	if (dt > 0)
+	{
+		velocity += (velocity_gain / dt) * error;
+	}
+
+	// nlerp towards the tracker on the shorter arc
+	float dot = orientation.w() * tracker_orientation.w() + orientation.x() * tracker_orientation.x()
+		+ orientation.y() * tracker_orientation.y() + orientation.z() * tracker_orientation.z();
+	if (dot < 0)
+	{
+		tracker_orientation = quat(-tracker_orientation.w(), -tracker_orientation.x(), -tracker_orientation.y(), -tracker_orientation.z());
+	}
+	float k = orientation_gain;
+	orientation = quat(
+		(1 - k) * orientation.w() + k * tracker_orientation.w(), (1 - k) * orientation.x() + k * tracker_orientation.x(),
+		(1 - k) * orientation.y() + k * tracker_orientation.y(), (1 - k) * orientation.z() + k * tracker_orientation.z());
+	orientation.normalize();
+
+	last_correction = t;
+	timestamp = max(timestamp, t);
+}
+
+void palm_fusion::integrate(const palm_sample& sample)
+{
+	if (!has_imu)
+	{
+		last_imu_rotation = sample.rotation;
+		last_imu_time = sample.timestamp;
+		has_imu = true;
+		return;
+	}
+
+	// rotation of the IMU in its own frame since the last sample
+	quat delta = last_imu_rotation.inverse() * sample.rotation;
+	float imu_dt = chrono::duration<float>(sample.timestamp - last_imu_time).count();
+	last_imu_rotation = sample.rotation;
+	last_imu_time = sample.timestamp;
+	if (!has_pose || sample.timestamp <= timestamp)
+	{
+		return;
+	}
+
+	// the delta applied from the right turns about the estimate's rotated axis
+	if (delta.w() < 0)
+	{
+		delta = quat(-delta.w(), -delta.x(), -delta.y(), -delta.z());
+	}
+	vec3 axis(delta.x(), delta.y(), delta.z());
+	float sin_half = axis.length();
+	vec3 new_angular_velocity(0);
+	if (sin_half > 1e-6f && imu_dt > 0)
+	{
+		new_angular_velocity = orientation.get_rotated(axis) * (2 * atan2(sin_half, delta.w()) / (sin_half * imu_dt));
+	}
+	angular_velocity = angular_smoothing * angular_velocity + (1 - angular_smoothing) * new_angular_velocity;
+
+	orientation = orientation * delta;
+	orientation.normalize();
+
+	// measured acceleration minus gravity, both in model space
+	float dt = chrono::duration<float>(sample.timestamp - timestamp).count();
+	vec3 acceleration = gravity * orientation.get_rotated(sample.acceleration) - vec3(0, gravity, 0);
+	acceleration = world_to_model * acceleration;
+	position += dt * velocity + (.5f * dt * dt) * acceleration;
+	velocity += dt * acceleration;
+	timestamp = sample.timestamp;
+}
+
+void palm_fusion::update(const glove_snapshot& glove, chrono::steady_clock::time_point pose_time,
+	vec3 tracker_position, quat tracker_orientation)
+{
+	int i = 0;
+	for (; i < glove.num_palm_samples && glove.palm_samples[i].timestamp <= pose_time; i++)
+	{
+		integrate(glove.palm_samples[i]);
+	}
+	correct(pose_time, tracker_position, tracker_orientation);
+	for (; i < glove.num_palm_samples; i++)
+	{
+		integrate(glove.palm_samples[i]);
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+
+#include "nd_device.h"
+
+using namespace std;
+typedef cgv::render::render_types::mat3 mat3;
+
+// complementary filter for the palm pose
+// between tracker poses, the palm IMU's rotation delta and acceleration
+// carry the pose forward at the glove's rate
+// each tracker pose pulls the estimate back, removing drift
+// assumes the palm IMU's axes are aligned with the tracker's
+class palm_fusion
+{
+	// estimate in model space, orientation in tracker space like the poses
+	vec3 position, velocity;
+	quat orientation;
+	chrono::steady_clock::time_point timestamp;
+	// rad/s in tracker space, applied from the left, measured by the palm IMU only
+	vec3 angular_velocity;
+
+	// palm IMU rotation and time of the last sample, its delta rotates the estimate
+	quat last_imu_rotation;
+	chrono::steady_clock::time_point last_imu_time;
+	bool has_imu;
+
+	// last tracker pose
+	chrono::steady_clock::time_point last_correction;
+	bool has_pose;
+
+	// rotation part of world to model, accelerations are measured in world space
+	mat3 world_to_model;
+
+	const float gravity = 9.81f;
+	// weight of the previous angular velocity against IMU noise
+	const float angular_smoothing = .5f;
+
+public:
+	// share of the position error removed per tracker pose
+	float position_gain;
+	// share of the position error per second added to the velocity per tracker pose
+	float velocity_gain;
+	// share of the orientation error removed per tracker pose
+	float orientation_gain;
+
+	palm_fusion();
+
+	void set_world_to_model(const mat3& a_world_to_model) { world_to_model = a_world_to_model; }
+
+	// tracker pose, position in model space
+	// repeated timestamps are ignored
+	void correct(chrono::steady_clock::time_point t, vec3 tracker_position, quat tracker_orientation);
+
+	// palm IMU reading, samples must come in order
+	void integrate(const palm_sample& sample);
+
+	// feeds the palm samples and the tracker pose in time order
+	void update(const glove_snapshot& glove, chrono::steady_clock::time_point pose_time,
+		vec3 tracker_position, quat tracker_orientation);
+
+	// false before the first tracker pose
+	bool has_estimate() const { return has_pose; }
+
+	// true once the palm IMU carries the estimate, its velocities are valid then
+	// corrections move the estimate in steps, so only these velocities describe its motion
+	bool has_velocity() const { return has_pose && has_imu; }
+
+	// estimate at get_timestamp()
+	vec3 get_position() const { return position; }
+	quat get_orientation() const { return orientation; }
+	chrono::steady_clock::time_point get_timestamp() const { return timestamp; }
+	vec3 get_velocity() const { return velocity; }
+	vec3 get_angular_velocity() const { return angular_velocity; }
+};
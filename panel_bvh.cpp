@@ -0,0 +1,172 @@
+#include "panel_bvh.h"
+
+#include <algorithm>
+#include <limits>
+
+void panel_bvh::build(panel_node* tree)
+{
+	root = tree;
+	elements.clear();
+	root->collect_rec(elements);
+	lowers.resize(elements.size());
+	uppers.resize(elements.size());
+	for (size_t i = 0; i < elements.size(); i++)
+	{
+		elements[i]->get_bounds(lowers[i], uppers[i]);
+	}
+
+	nodes.clear();
+	nodes.reserve(2 * elements.size());
+	nodes.push_back(bvh_node());
+	build_rec(0, 0, elements.size());
+	refit();
+}
+
+void panel_bvh::build_rec(int node, int first, int count)
+{
+	nodes[node].first = first;
+	nodes[node].count = count;
+	nodes[node].left = -1;
+	if (count <= max_leaf_size)
+	{
+		return;
+	}
+
+	// extent of the box centers
+	vec3 lower(numeric_limits<float>::max()), upper(-numeric_limits<float>::max());
+	for (int i = first; i < first + count; i++)
+	{
+		vec3 center = .5f * (lowers[i] + uppers[i]);
+		for (int k = 0; k < 3; k++)
+		{
+			lower[k] = min(lower[k], center[k]);
+			upper[k] = max(upper[k], center[k]);
+		}
+	}
+	vec3 extent = upper - lower;
+	int axis = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2) : (extent[1] > extent[2] ? 1 : 2);
+
+	// median split, elements and their bounds are permuted together
+	vector<int> order(count);
+	for (int i = 0; i < count; i++)
+	{
+		order[i] = first + i;
+	}
+	int half = count / 2;
+	nth_element(order.begin(), order.begin() + half, order.end(), [&](int a, int b) {
+		return lowers[a][axis] + uppers[a][axis] < lowers[b][axis] + uppers[b][axis];
+	});
+	vector<panel_node*> sorted_elements(count);
+	vector<vec3> sorted_lowers(count), sorted_uppers(count);
+	for (int i = 0; i < count; i++)
+	{
+		sorted_elements[i] = elements[order[i]];
+		sorted_lowers[i] = lowers[order[i]];
+		sorted_uppers[i] = uppers[order[i]];
+	}
+	copy(sorted_elements.begin(), sorted_elements.end(), elements.begin() + first);
+	copy(sorted_lowers.begin(), sorted_lowers.end(), lowers.begin() + first);
+	copy(sorted_uppers.begin(), sorted_uppers.end(), uppers.begin() + first);
+
+	int left = nodes.size();
+	nodes[node].left = left;
+	nodes[node].count = 0;
+	nodes.push_back(bvh_node());
+	nodes.push_back(bvh_node());
+	build_rec(left, first, half);
+	build_rec(left + 1, first + half, count - half);
+}
+
+void panel_bvh::refit()
+{
+	for (size_t i = 0; i < elements.size(); i++)
+	{
+		elements[i]->get_bounds(lowers[i], uppers[i]);
+		elements[i]->clear_moved();
+	}
+
+	// children always come after their parent
+	for (int n = nodes.size() - 1; n >= 0; n--)
+	{
+		bvh_node& node = nodes[n];
+		if (node.left < 0)
+		{
+			node.lower = lowers[node.first];
+			node.upper = uppers[node.first];
+			for (int i = node.first + 1; i < node.first + node.count; i++)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					node.lower[k] = min(node.lower[k], lowers[i][k]);
+					node.upper[k] = max(node.upper[k], uppers[i][k]);
+				}
+			}
+		}
+		else
+		{
+			const bvh_node& l = nodes[node.left];
+			const bvh_node& r = nodes[node.left + 1];
+			for (int k = 0; k < 3; k++)
+			{
+				node.lower[k] = min(l.lower[k], r.lower[k]);
+				node.upper[k] = max(l.upper[k], r.upper[k]);
+			}
+		}
+	}
+}
+
+void panel_bvh::update()
+{
+	if (root && root->has_subtree_moved())
+	{
+		refit();
+	}
+}
+
+void panel_bvh::query(vec3 position, float tolerance, int joint, vector<panel_node*>& hits)
+{
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	// boxes are grown by tolerance, a joint touches elements closer than that
+	auto is_near = [&](const vec3& lower, const vec3& upper) {
+		for (int k = 0; k < 3; k++)
+		{
+			if (position[k] < lower[k] - tolerance || position[k] > upper[k] + tolerance)
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	int stack[64];
+	int stack_size = 0;
+	stack[stack_size++] = 0;
+	while (stack_size > 0)
+	{
+		const bvh_node& node = nodes[stack[--stack_size]];
+		if (!is_near(node.lower, node.upper))
+		{
+			continue;
+		}
+
+		if (node.left < 0)
+		{
+			for (int i = node.first; i < node.first + node.count; i++)
+			{
+				if (is_near(lowers[i], uppers[i]) && elements[i]->add_candidate(joint))
+				{
+					hits.push_back(elements[i]);
+				}
+			}
+		}
+		else
+		{
+			stack[stack_size++] = node.left;
+			stack[stack_size++] = node.left + 1;
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include "panel_element.h"
+
+using namespace std;
+
+// bounding volume hierarchy over the world boxes of all elements of a panel tree
+// a containment query only tests the elements whose boxes a joint is close to
+// built once, refit when an element moved
+class panel_bvh
+{
+	struct bvh_node
+	{
+		vec3 lower, upper;
+		// inner nodes: children at left and left + 1, leaves: elements[first, first + count)
+		int left, first, count;
+	};
+
+	// depth first, a node's children follow it
+	vector<bvh_node> nodes;
+	// in leaf order
+	vector<panel_node*> elements;
+	vector<vec3> lowers, uppers;
+	panel_node* root;
+
+	// leaves never hold more elements
+	static const int max_leaf_size = 2;
+
+	// splits elements[first, first + count) at the median along the longest axis of their centers
+	void build_rec(int node, int first, int count);
+
+	// recomputes the bounds of all elements and nodes
+	void refit();
+
+public:
+	panel_bvh() : root(nullptr) {}
+
+	void build(panel_node* tree);
+
+	// refits the element and node bounds if an element moved since the last call
+	void update();
+
+	// adds joint to the candidates of every element within tolerance of position
+	// elements that had no candidate before are appended to hits
+	void query(vec3 position, float tolerance, int joint, vector<panel_node*>& hits);
+};
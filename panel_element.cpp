@@ -1,5 +1,7 @@
 #include "panel_element.h"
 
+#include <limits>
+
 void panel_node::set_geometry(vec3 a_position, vec3 a_extent, vec3 a_translation, vec3 a_angles, rgb a_color)
 {
 	geometry tmp;
@@ -39,6 +41,45 @@ void panel_node::set_geometry(geometry g)
 	geo.color = g.color;
 
 	geo.has_changed = true;
+	mark_moved();
+}
+
+void panel_node::mark_moved()
+{
+	for (panel_node* n = this; n; n = n->parent)
+	{
+		n->is_subtree_moved = true;
+	}
+}
+
+void panel_node::collect_rec(vector<panel_node*>& nodes)
+{
+	nodes.push_back(this);
+	for (auto child : children)
+	{
+		child->collect_rec(nodes);
+	}
+}
+
+void panel_node::get_bounds(vec3& lower, vec3& upper)
+{
+	// local box as seen by distance(), open towards -y down to max_touch_depth
+	float lower_y = -.5f * geo.extent.y() - max_touch_depth;
+	vec3 center(.0f, .5f * (lower_y + .5f * geo.extent.y()), .0f);
+	vec3 half(.5f * geo.extent.x(), .5f * (.5f * geo.extent.y() - lower_y), .5f * geo.extent.z());
+
+	vec3 axes[3] = {
+		geo.rotation.get_rotated(vec3(1, 0, 0)),
+		geo.rotation.get_rotated(vec3(0, 1, 0)),
+		geo.rotation.get_rotated(vec3(0, 0, 1))
+	};
+	vec3 world_center = geo.position + geo.translation + center.y() * axes[1];
+	for (int k = 0; k < 3; k++)
+	{
+		float r = abs(axes[0][k]) * half.x() + abs(axes[1][k]) * half.y() + abs(axes[2][k]) * half.z();
+		lower[k] = world_center[k] - r;
+		upper[k] = world_center[k] + r;
+	}
 }
 
 // returns geometry of this element and its children
@@ -74,49 +115,67 @@ bool panel_node::geometry_changed()
 	return result;
 }
 
-// returns a map of indices of contained ci.positions vs. vibration strength
-// saves ci as one of cis
+// tests the candidates against this element's box and clears them
+// raises strengths[i] to the vibration strength of joint i if it touches,
+// touches are felt at least at the max_vibration_strength of every ancestor
+// returns the touching joints
 
-map<int, float> panel_node::check_containments(containment_info ci, int hand_loc)
+uint64_t panel_node::test_candidates(const containment_info& ci, float* strengths)
 {
-	cis[hand_loc] = ci;
-	map<int, float> ind_map;
+	float min_strength = 0;
+	for (panel_node* n = parent; n; n = n->parent)
+	{
+		min_strength = max(min_strength, n->max_vibration_strength);
+	}
+
+	uint64_t joints = 0;
 	float dist;
-	for (size_t i = 0; i < ci.positions.size(); i++)
+	for (int i : candidates)
 	{
 		dist = distance(ci.positions[i]);
-		if (dist < ci.tolerance)
+		if (dist < ci.tolerance && i < max_containment_joints)
 		{
-			ind_map[i] = min_vibration_strength 
+			float strength = min_vibration_strength
 				+ sqrt(1.0f - dist / ci.tolerance) * (max_vibration_strength - min_vibration_strength);
+			strengths[i] = max(strengths[i], max(strength, min_strength));
+			joints |= uint64_t(1) << i;
 		}
 	}
+	candidates.clear();
 
-	for (auto child : children)
+	return joints;
+}
+
+// saves joints as touches[hand_index], the joints touching this element or one below it,
+// and calls on_touch() if there are any or on_no_touch() if not
+
+void panel_node::set_touches(const containment_info& ci, int hand_index, uint64_t joints)
+{
+	if (hand_index >= (int)touches.size())
 	{
-		for each (auto p in child->check_containments(ci, hand_loc))
-		{
-			ind_map[p.first] = max(p.second, max_vibration_strength);
-		}
+		touches.resize(hand_index + 1);
 	}
-
-	cis[hand_loc].ind_map = ind_map;
-	calc_responsiveness(cis[hand_loc]);
-	if (ind_map.size())
+	num_touching_joints -= touches[hand_index].get_num_joints();
+	touches[hand_index].joints = joints;
+	num_touching_joints += touches[hand_index].get_num_joints();
+	calc_responsiveness(ci);
+	if (joints)
 	{
-		on_touch(hand_loc);
+		on_touch(hand_index, ci);
 	}
 	else
 	{
 		on_no_touch();
 	}
-
-	return ind_map;
 }
 
 float panel_node::distance(vec3 v)
 {
 	v = to_local(v);
+	if (v.y() < -.5f * geo.extent.y() - max_touch_depth)
+	{
+		return numeric_limits<float>::max();
+	}
 	float dist_x = max(.0f, abs(v.x()) - .5f * geo.extent.x());
 	float dist_y = max(.0f, v.y() - .5f * geo.extent.y());
 	float dist_z = max(.0f, abs(v.z()) - .5f * geo.extent.z());
@@ -126,10 +185,11 @@ float panel_node::distance(vec3 v)
 
 // sets is_responsive = true if this element should be responsive to touch
 
-void panel_node::calc_responsiveness(containment_info ci)
+void panel_node::calc_responsiveness(const containment_info& ci)
 {
-	is_responsive = is_responsive && cis[0].ind_map.size() + cis[1].ind_map.size() == 1
-		|| cis[0].ind_map.size() + cis[1].ind_map.size() == 0;
+	// running total instead of a sum over all hands
+	is_responsive = is_responsive && num_touching_joints == 1
+		|| num_touching_joints == 0;
 }
 
 // transforms v to this element's space
@@ -154,7 +214,7 @@ button::button(vec3 a_position, vec3 a_extent, vec3 a_translation, vec3 angles,
 	is_active = false;
 }
 
-void button::on_touch(int hand_loc)
+void button::on_touch(int, const containment_info&)
 {
 	if (is_responsive)
 	{
@@ -165,7 +225,7 @@ void button::on_touch(int hand_loc)
 	is_responsive = false;
 }
 
-void hold_button::on_touch(int hand_loc)
+void hold_button::on_touch(int, const containment_info&)
 {
 	if (is_responsive)
 	{
@@ -176,7 +236,7 @@ void hold_button::on_touch(int hand_loc)
 
 void hold_button::on_no_touch()
 {
-	if (!cis[0].ind_map.size() && !cis[1].ind_map.size())
+	if (!num_touching_joints)
 	{
 		set_color(base_color);
 	}
@@ -209,12 +269,12 @@ void hold_button::on_no_touch()
 	}
 }
 
- void slider::on_touch(int hand_loc)
+ void slider::on_touch(int hand_index, const containment_info& ci)
  {
 	 if (is_responsive)
 	 {
-		 int touch_ind = cis[hand_loc].ind_map.begin()->first;
-		 float new_value = vec_to_val(cis[hand_loc].positions[touch_ind]);
+		 int touch_ind = touches[hand_index].get_first_joint();
+		 float new_value = vec_to_val(ci.positions[touch_ind]);
 		 if (abs(new_value - value) < value_tolerance)
 		 {
 			 value = new_value;
@@ -299,12 +359,12 @@ void hold_button::on_no_touch()
 	 }
  }
 
- void pos_neg_slider::on_touch(int hand_loc)
+ void pos_neg_slider::on_touch(int hand_index, const containment_info& ci)
  {
 	 if (is_responsive)
 	 {
-		 int touch_ind = cis[hand_loc].ind_map.begin()->first;
-		 value = vec_to_val(cis[hand_loc].positions[touch_ind]);
+		 int touch_ind = touches[hand_index].get_first_joint();
+		 value = vec_to_val(ci.positions[touch_ind]);
 		 callback(sphere, value);
 		 set_indicator_colors();
 	 }
@@ -405,7 +465,7 @@ void hold_button::on_no_touch()
 	 }
  }
 
- void lever::on_touch(int hand_loc)
+ void lever::on_touch(int, const containment_info& ci)
  {
 	 if (!is_responsive)
 	 {
@@ -413,7 +473,7 @@ void hold_button::on_no_touch()
 	 }
 	 geo.rotation = parent->get_rotation() * quat_yz;
 
-	 vec3 touch_loc = to_local(cis[hand_loc].positions[0]);
+	 vec3 touch_loc = to_local(ci.positions[0]);
 	 touch_loc.x() = 0;
 	 touch_loc.normalize();
 	 vec3 cr = cross(vec3(0, 1, 0), touch_loc);
@@ -425,6 +485,7 @@ void hold_button::on_no_touch()
 	 geo.rotation = parent->get_rotation() * quat_yz * quat(vec3(1, 0, 0), angle_x);
 	 update_children();
 	 geo.has_changed = true;
+	 mark_moved();
  }
 
  void lever::update_children()
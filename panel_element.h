@@ -2,6 +2,9 @@
 
 #include <cgv/render/drawable.h>
 
+#include <bitset>
+#include <cstdint>
+
 #include "space.h"
 
 typedef cgv::render::render_types::vec3 vec3;
@@ -60,31 +63,69 @@ struct group_geometry
 	}
 };
 
-// for containment check
+// joints beyond are never contained
+const int max_containment_joints = 64;
+
+// for containment check, views the caller's joints without copying them
 struct containment_info
 {
-	// positions of joints
-	vector<vec3> positions;
-	// indices of contained joints
-	map<int, float> ind_map;
+	// positions of joints, owned by the caller
+	const vec3* positions;
+	size_t num_positions;
 	// are joined: thumb+index, thumb+middle, palm+index, palm+middle
 	bool contacts[4];
 	// tolerance for containment check
 	float tolerance;
 };
 
+// joints of one hand touching an element or one below it
+struct touch_record
+{
+	// bit i is set if joint i touches
+	uint64_t joints = 0;
+
+	size_t get_num_joints() const { return bitset<max_containment_joints>(joints).count(); }
+
+	// lowest touching joint, -1 if there is none
+	int get_first_joint() const
+	{
+		for (int i = 0; i < max_containment_joints; i++)
+		{
+			if (joints >> i & 1)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+};
+
 class panel_node
 {
 protected:
 	panel_node* parent;
 	vector<panel_node*> children;
+	// 0 for the root
+	int depth;
 
 	geometry geo;
 	group_geometry last_group_geo;
 	float min_vibration_strength = .05f, 
 	      max_vibration_strength = .2f;
-
-	vector<containment_info> cis;
+	// joints deeper below the bottom face do not touch
+	static constexpr float max_touch_depth = .05f;
+
+	// joints panel_bvh found close to this element's box
+	vector<int> candidates;
+	// joints of the running query touching this element or one below it, 0 between queries
+	uint64_t query_joints = 0;
+	// set when this element or one below it moved since the last clear_moved()
+	bool is_subtree_moved = true;
+
+	// one slot per hand, grows with the highest hand index seen
+	vector<touch_record> touches;
+	// sum of touches[i].get_num_joints() over all hands
+	size_t num_touching_joints;
 	bool is_responsive;
 
 public:
@@ -101,7 +142,7 @@ public:
 	{};
 
 	panel_node(geometry local_geo, panel_node* parent_ptr)
-		: cis(2), is_responsive(true)
+		: num_touching_joints(0), is_responsive(true)
 	{
 		add_to_tree(parent_ptr);
 		set_geometry(local_geo);
@@ -110,14 +151,39 @@ public:
 	void add_to_tree(panel_node* parent_ptr)
 	{
 		parent = parent_ptr;
+		depth = parent ? parent->depth + 1 : 0;
 		if (parent) parent->children.push_back(this);
 	}
 
+	panel_node* get_parent() { return parent; }
+
+	int get_depth() const { return depth; }
+
 	void set_geometry(vec3 a_position, vec3 a_extent, vec3 a_translation,
 		vec3 a_angles, rgb a_color);
 
 	void set_geometry(geometry g);
 
+	// flags this element and its ancestors as moved
+	void mark_moved();
+
+	bool has_subtree_moved() { return is_subtree_moved; }
+
+	void clear_moved() { is_subtree_moved = false; }
+
+	// appends this element and all below it to nodes
+	void collect_rec(vector<panel_node*>& nodes);
+
+	// world space box around all points distance() can be below a tolerance of 0 for
+	void get_bounds(vec3& lower, vec3& upper);
+
+	// returns true for the first candidate since the last test_candidates()
+	bool add_candidate(int joint)
+	{
+		candidates.push_back(joint);
+		return candidates.size() == 1;
+	}
+
 	// returns geometry of this element and its children
 	virtual group_geometry get_geometry_rec();
 
@@ -125,17 +191,36 @@ public:
 	// since last get_geometry_rec() call
 	bool geometry_changed();
 
-	// returns a map of indices of contained ci.positions vs. vibration strength
-	// saves ci as one of cis
-	map<int, float> check_containments(containment_info ci, int hand_loc);
+	// tests the candidates against this element's box and clears them
+	// raises strengths[i] to the vibration strength of joint i if it touches,
+	// touches are felt at least at the max_vibration_strength of every ancestor
+	// returns the touching joints
+	uint64_t test_candidates(const containment_info& ci, float* strengths);
+
+	// adds joints to query_joints, returns true if query_joints was 0 before
+	bool add_query_joints(uint64_t joints)
+	{
+		bool is_first = query_joints == 0;
+		query_joints |= joints;
+		return is_first;
+	}
+
+	uint64_t get_query_joints() const { return query_joints; }
+
+	void clear_query_joints() { query_joints = 0; }
+
+	// saves joints as touches[hand_index], the joints touching this element or one below it,
+	// and calls on_touch() if there are any or on_no_touch() if not
+	void set_touches(const containment_info& ci, int hand_index, uint64_t joints);
 
 	virtual float distance(vec3 v);
 
-	virtual void on_touch(int hand_loc) {};
+	// hand_index is the hand whose joints in ci touch this element
+	virtual void on_touch(int, const containment_info&) {};
 	virtual void on_no_touch() {};
 
 	// sets is_responsive = true if this element should be responsive to touch
-	virtual void calc_responsiveness(containment_info ci);
+	virtual void calc_responsiveness(const containment_info& ci);
 
 	// transforms v to this element's space
 	vec3 to_local(vec3 v);
@@ -165,7 +250,7 @@ public:
 		space* a_space, void (*a_callback)(space*),
 		panel_node* parent_ptr);
 
-	virtual void on_touch(int hand_loc) override;
+	virtual void on_touch(int hand_index, const containment_info& ci) override;
 };
 
 // button that is active as long as it is touched
@@ -173,9 +258,9 @@ class hold_button : public button
 {
 	using button::button;
 
-	void calc_responsiveness(containment_info ci) override { is_responsive = true; }
+	void calc_responsiveness(const containment_info& ci) override { is_responsive = true; }
 
-	void on_touch(int hand_loc) override;
+	void on_touch(int hand_index, const containment_info& ci) override;
 
 	void on_no_touch() override;
 };
@@ -198,7 +283,7 @@ public:
 		   space* a_space, void (*a_callback)(space*, float),
 		panel_node* parent_ptr);
 
-	void on_touch(int hand_loc) override;
+	void on_touch(int hand_index, const containment_info& ci) override;
 	
 	float vec_to_val(vec3 v);
 	
@@ -224,7 +309,7 @@ public:
 		   space* a_sphere, void (*a_callback)(space*, float),
 		panel_node* parent_ptr);
 
-	void on_touch(int hand_loc) override;
+	void on_touch(int hand_index, const containment_info& ci) override;
 	
 	float vec_to_val(vec3 v);
 	
@@ -251,9 +336,9 @@ public:
 		panel_node* parent_ptr);
 
 	// responsive on grab (closed hand)
-	void calc_responsiveness(containment_info ci) override { is_responsive = ci.contacts[3]; }
+	void calc_responsiveness(const containment_info& ci) override { is_responsive = ci.contacts[3]; }
 
-	void on_touch(int hand_loc) override;
+	void on_touch(int hand_index, const containment_info& ci) override;
 
 	void update_children();
 };
\ No newline at end of file
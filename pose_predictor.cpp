@@ -0,0 +1,195 @@
+#include "pose_predictor.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	float seconds_between(chrono::steady_clock::time_point from, chrono::steady_clock::time_point to)
+	{
+		return chrono::duration<float>(to - from).count();
+	}
+}
+
+void rotation_predictor::add(chrono::steady_clock::time_point t, quat q, float smoothing)
+{
+	q.normalize();
+	if (has_sample && t > timestamp)
+	{
+		// delta rotation on the shortest arc
+		quat d = q * rotation.inverse();
+		if (d.w() < 0)
+		{
+			d = quat(-d.w(), -d.x(), -d.y(), -d.z());
+		}
+
+		vec3 axis(d.x(), d.y(), d.z());
+		float sin_half = axis.length(),
+			angle = 2 * atan2(sin_half, d.w());
+		vec3 new_velocity(0);
+		if (sin_half > 1e-6f)
+		{
+			new_velocity = axis * (angle / (sin_half * seconds_between(timestamp, t)));
+		}
+		velocity = smoothing * velocity + (1 - smoothing) * new_velocity;
+	}
+	else if (!has_sample)
+	{
+		velocity = vec3(0);
+	}
+
+	timestamp = t;
+	rotation = q;
+	has_sample = true;
+}
+
+void rotation_predictor::set(chrono::steady_clock::time_point t, quat q, vec3 a_velocity)
+{
+	q.normalize();
+	timestamp = t;
+	rotation = q;
+	velocity = a_velocity;
+	has_sample = true;
+}
+
+void rotation_predictor::predict(chrono::steady_clock::time_point target, float max_horizon_s, quat& q) const
+{
+	if (!has_sample)
+	{
+		return;
+	}
+
+	float dt = min(max(seconds_between(timestamp, target), .0f), max_horizon_s),
+		speed = velocity.length();
+	if (speed * dt < 1e-6f)
+	{
+		q = rotation;
+		return;
+	}
+
+	q = quat(velocity / speed, speed * dt) * rotation;
+	q.normalize();
+}
+
+float rotation_predictor::angle_between(quat a, quat b)
+{
+	a.normalize();
+	b.normalize();
+	float d = abs(a.w() * b.w() + a.x() * b.x() + a.y() * b.y() + a.z() * b.z());
+	return 2 * acos(min(d, 1.0f));
+}
+
+void position_predictor::add(chrono::steady_clock::time_point t, vec3 p, float smoothing)
+{
+	if (has_sample && t > timestamp)
+	{
+		vec3 new_velocity = (p - position) / seconds_between(timestamp, t);
+		velocity = smoothing * velocity + (1 - smoothing) * new_velocity;
+	}
+	else if (!has_sample)
+	{
+		velocity = vec3(0);
+	}
+
+	timestamp = t;
+	position = p;
+	has_sample = true;
+}
+
+void position_predictor::set(chrono::steady_clock::time_point t, vec3 p, vec3 a_velocity)
+{
+	timestamp = t;
+	position = p;
+	velocity = a_velocity;
+	has_sample = true;
+}
+
+void position_predictor::predict(chrono::steady_clock::time_point target, float max_horizon_s, vec3& p) const
+{
+	if (!has_sample)
+	{
+		return;
+	}
+
+	float dt = min(max(seconds_between(timestamp, target), .0f), max_horizon_s);
+	p = position + dt * velocity;
+}
+
+void pose_predictor::add_pose(chrono::steady_clock::time_point t, vec3 position, quat orientation)
+{
+	if (t == chrono::steady_clock::time_point() || t == palm_orientation.get_timestamp())
+	{
+		return;
+	}
+
+	palm_position.add(t, position, smoothing);
+	palm_orientation.add(t, orientation, smoothing);
+}
+
+void pose_predictor::add_pose(chrono::steady_clock::time_point t, vec3 position, vec3 velocity,
+	quat orientation, vec3 angular_velocity)
+{
+	if (t == chrono::steady_clock::time_point() || t == palm_orientation.get_timestamp())
+	{
+		return;
+	}
+
+	palm_position.set(t, position, velocity);
+	palm_orientation.set(t, orientation, angular_velocity);
+}
+
+void pose_predictor::add_imus(chrono::steady_clock::time_point t, const imu_rotation_array& rotations)
+{
+	if (t == chrono::steady_clock::time_point() || t == imus[0].get_timestamp())
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < max_num_imus; i++)
+	{
+		imus[i].add(t, rotations[i], smoothing);
+	}
+}
+
+void pose_predictor::predict(chrono::steady_clock::time_point display_time,
+	vec3& position, quat& orientation, imu_rotation_array& rotations) const
+{
+	palm_position.predict(display_time, max_horizon_s, position);
+	palm_orientation.predict(display_time, max_horizon_s, orientation);
+	for (size_t i = 0; i < max_num_imus; i++)
+	{
+		imus[i].predict(display_time, max_horizon_s, rotations[i]);
+	}
+}
+
+float pose_predictor::replay_error_deg(const vector<pair<chrono::steady_clock::time_point, quat>>& recording, float horizon_ms)
+{
+	pose_predictor p;
+	chrono::steady_clock::duration horizon = chrono::microseconds((long long)(1000 * horizon_ms));
+	float error_sum = 0;
+	size_t num_errors = 0, future = 0;
+	for (size_t i = 0; i < recording.size(); i++)
+	{
+		rotation_predictor& r = p.imus[0];
+		r.add(recording[i].first, recording[i].second, p.smoothing);
+
+		// first recorded sample at or after the predicted time
+		chrono::steady_clock::time_point target = recording[i].first + horizon;
+		future = max(future, i);
+		while (future < recording.size() && recording[future].first < target)
+		{
+			future++;
+		}
+		if (future == recording.size())
+		{
+			break;
+		}
+
+		quat predicted = recording[i].second;
+		r.predict(recording[future].first, p.max_horizon_s, predicted);
+		error_sum += rotation_predictor::angle_between(predicted, recording[future].second);
+		num_errors++;
+	}
+
+	return num_errors ? float(180 / M_PI) * error_sum / num_errors : .0f;
+}
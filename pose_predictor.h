@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "nd_device.h"
+
+using namespace std;
+
+// first order extrapolation of a timestamped rotation
+// angular velocity is estimated from consecutive samples
+class rotation_predictor
+{
+	chrono::steady_clock::time_point timestamp;
+	quat rotation;
+	// rad/s, applied from the left
+	vec3 velocity;
+	bool has_sample;
+
+public:
+	rotation_predictor()
+		: rotation(1, 0, 0, 0), velocity(0), has_sample(false)
+	{}
+
+	// smoothing in [0, 1) weights the previous velocity estimate
+	void add(chrono::steady_clock::time_point t, quat q, float smoothing);
+
+	// sample whose velocity is known, nothing is estimated
+	void set(chrono::steady_clock::time_point t, quat q, vec3 a_velocity);
+
+	// rotation at target, extrapolated at most max_horizon_s past the last sample
+	// q is left unchanged if there is no sample yet
+	void predict(chrono::steady_clock::time_point target, float max_horizon_s, quat& q) const;
+
+	chrono::steady_clock::time_point get_timestamp() const { return timestamp; }
+
+	// angle between two rotations in radians
+	static float angle_between(quat a, quat b);
+};
+
+// first order extrapolation of a timestamped position
+class position_predictor
+{
+	chrono::steady_clock::time_point timestamp;
+	vec3 position, velocity;
+	bool has_sample;
+
+public:
+	position_predictor()
+		: position(0), velocity(0), has_sample(false)
+	{}
+
+	void add(chrono::steady_clock::time_point t, vec3 p, float smoothing);
+
+	// sample whose velocity is known, nothing is estimated
+	void set(chrono::steady_clock::time_point t, vec3 p, vec3 a_velocity);
+
+	void predict(chrono::steady_clock::time_point target, float max_horizon_s, vec3& p) const;
+};
+
+// predicts palm pose and IMU rotations of one hand to display time
+// independent of rendering, so recorded data can be replayed offline
+class pose_predictor
+{
+	position_predictor palm_position;
+	rotation_predictor palm_orientation;
+	rotation_predictor imus[max_num_imus];
+
+	// weight of the previous velocity estimate against IMU and tracker noise
+	const float smoothing = .5f;
+	// a stalled stream is not extrapolated further than this
+	const float max_horizon_s = .05f;
+
+public:
+	// repeated timestamps are ignored, so both can be fed every frame
+	void add_pose(chrono::steady_clock::time_point t, vec3 position, quat orientation);
+	// for poses of a filter that estimates its own velocities, e.g. palm_fusion
+	// its corrections would read as velocity spikes if consecutive poses were differentiated
+	// angular_velocity is in rad/s and applied from the left
+	void add_pose(chrono::steady_clock::time_point t, vec3 position, vec3 velocity,
+		quat orientation, vec3 angular_velocity);
+	void add_imus(chrono::steady_clock::time_point t, const imu_rotation_array& rotations);
+
+	// overwrites the arguments with the prediction for display_time
+	// values without samples are left as passed
+	void predict(chrono::steady_clock::time_point display_time,
+		vec3& position, quat& orientation, imu_rotation_array& rotations) const;
+
+	// offline benchmark, run by bench/: feeds recording sample by sample and compares the
+	// prediction horizon_ms ahead with the recorded rotation at that time
+	// returns the mean error in degrees
+	static float replay_error_deg(const vector<pair<chrono::steady_clock::time_point, quat>>& recording, float horizon_ms);
+};
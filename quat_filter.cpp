@@ -0,0 +1,193 @@
+#include "quat_filter.h"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUAT_FILTER_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	const size_t simd_width = 4;
+	const float two_pi = 2 * float(M_PI);
+}
+
+quat_filter::quat_filter(size_t a_num_channels)
+	: num_channels(0), num_padded(0), last_process_us(0), beta(.5f), speed_cutoff(1.0f)
+{
+	resize(a_num_channels);
+}
+
+void quat_filter::resize(size_t a_num_channels)
+{
+	num_channels = a_num_channels;
+	num_padded = (num_channels + simd_width - 1) / simd_width * simd_width;
+
+	// padding channels are identity without input and never change
+	for (vector<float>* v : { &w, &in_w, &raw_w })
+	{
+		v->resize(num_padded, 1.0f);
+	}
+	for (vector<float>* v : { &x, &y, &z, &in_x, &in_y, &in_z, &raw_x, &raw_y, &raw_z, &speeds, &dts })
+	{
+		v->resize(num_padded, .0f);
+	}
+	min_cutoffs.resize(num_padded, 1.0f);
+	timestamps.resize(num_padded);
+}
+
+void quat_filter::set_input(size_t channel, quat q, chrono::steady_clock::time_point t)
+{
+	if (t == timestamps[channel])
+	{
+		return;
+	}
+
+	if (timestamps[channel] == chrono::steady_clock::time_point())
+	{
+		// first input passes unfiltered
+		w[channel] = raw_w[channel] = q.w();
+		x[channel] = raw_x[channel] = q.x();
+		y[channel] = raw_y[channel] = q.y();
+		z[channel] = raw_z[channel] = q.z();
+		dts[channel] = 0;
+	}
+	else
+	{
+		dts[channel] = chrono::duration<float>(t - timestamps[channel]).count();
+	}
+
+	in_w[channel] = q.w();
+	in_x[channel] = q.x();
+	in_y[channel] = q.y();
+	in_z[channel] = q.z();
+	timestamps[channel] = t;
+}
+
+void quat_filter::process()
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+#ifdef QUAT_FILTER_SSE
+	process_sse();
+#else
+	process_scalar();
+#endif
+
+	last_process_us = chrono::duration<float, micro>(chrono::steady_clock::now() - start).count();
+}
+
+void quat_filter::process_scalar()
+{
+	for (size_t i = 0; i < num_padded; i++)
+	{
+		float dt = dts[i];
+		if (dt <= 0)
+		{
+			continue;
+		}
+
+		// angular speed from consecutive inputs, small angle approximation
+		float raw_dot = abs(raw_w[i] * in_w[i] + raw_x[i] * in_x[i] + raw_y[i] * in_y[i] + raw_z[i] * in_z[i]),
+			angle = 2 * sqrt(max(1 - raw_dot * raw_dot, .0f)),
+			r = two_pi * speed_cutoff * dt;
+		speeds[i] += r / (1 + r) * (angle / dt - speeds[i]);
+
+		// nlerp towards the input on the shorter arc
+		float sign = w[i] * in_w[i] + x[i] * in_x[i] + y[i] * in_y[i] + z[i] * in_z[i] < 0 ? -1.0f : 1.0f;
+		r = two_pi * (min_cutoffs[i] + beta * speeds[i]) * dt;
+		float alpha = r / (1 + r);
+		w[i] += alpha * (sign * in_w[i] - w[i]);
+		x[i] += alpha * (sign * in_x[i] - x[i]);
+		y[i] += alpha * (sign * in_y[i] - y[i]);
+		z[i] += alpha * (sign * in_z[i] - z[i]);
+		float inv_len = 1 / sqrt(w[i] * w[i] + x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+		w[i] *= inv_len;
+		x[i] *= inv_len;
+		y[i] *= inv_len;
+		z[i] *= inv_len;
+
+		raw_w[i] = in_w[i];
+		raw_x[i] = in_x[i];
+		raw_y[i] = in_y[i];
+		raw_z[i] = in_z[i];
+		dts[i] = 0;
+	}
+}
+
+#ifdef QUAT_FILTER_SSE
+void quat_filter::process_sse()
+{
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f),
+		sign_bit = _mm_set1_ps(-.0f),
+		speed_r_per_dt = _mm_set1_ps(two_pi * speed_cutoff),
+		two_pi_v = _mm_set1_ps(two_pi), beta_v = _mm_set1_ps(beta);
+
+	for (size_t i = 0; i < num_padded; i += simd_width)
+	{
+		__m128 dt = _mm_loadu_ps(&dts[i]),
+			active = _mm_cmpgt_ps(dt, zero);
+		if (!_mm_movemask_ps(active))
+		{
+			continue;
+		}
+		// keeps inactive lanes finite, their results are discarded below
+		__m128 safe_dt = _mm_or_ps(_mm_and_ps(active, dt), _mm_andnot_ps(active, one));
+
+		__m128 iw = _mm_loadu_ps(&in_w[i]), ix = _mm_loadu_ps(&in_x[i]),
+			iy = _mm_loadu_ps(&in_y[i]), iz = _mm_loadu_ps(&in_z[i]);
+
+		// angular speed from consecutive inputs, small angle approximation
+		// sums run left to right as in process_scalar()
+		__m128 raw_dot = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_loadu_ps(&raw_w[i]), iw), _mm_mul_ps(_mm_loadu_ps(&raw_x[i]), ix)),
+			_mm_mul_ps(_mm_loadu_ps(&raw_y[i]), iy)), _mm_mul_ps(_mm_loadu_ps(&raw_z[i]), iz));
+		__m128 angle = _mm_mul_ps(two, _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(raw_dot, raw_dot)), zero)));
+		__m128 r = _mm_mul_ps(speed_r_per_dt, safe_dt),
+			speed = _mm_loadu_ps(&speeds[i]);
+		speed = _mm_add_ps(speed, _mm_mul_ps(_mm_div_ps(r, _mm_add_ps(one, r)),
+			_mm_sub_ps(_mm_div_ps(angle, safe_dt), speed)));
+
+		// nlerp towards the input on the shorter arc
+		__m128 ow = _mm_loadu_ps(&w[i]), ox = _mm_loadu_ps(&x[i]),
+			oy = _mm_loadu_ps(&y[i]), oz = _mm_loadu_ps(&z[i]);
+		__m128 dot = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ow, iw), _mm_mul_ps(ox, ix)),
+			_mm_mul_ps(oy, iy)), _mm_mul_ps(oz, iz));
+		// flips only below 0, not at -0
+		__m128 sign = _mm_and_ps(_mm_cmplt_ps(dot, zero), sign_bit);
+		iw = _mm_xor_ps(iw, sign);
+		ix = _mm_xor_ps(ix, sign);
+		iy = _mm_xor_ps(iy, sign);
+		iz = _mm_xor_ps(iz, sign);
+
+		r = _mm_mul_ps(_mm_mul_ps(two_pi_v, _mm_add_ps(_mm_loadu_ps(&min_cutoffs[i]), _mm_mul_ps(beta_v, speed))), safe_dt);
+		__m128 alpha = _mm_div_ps(r, _mm_add_ps(one, r));
+		__m128 nw = _mm_add_ps(ow, _mm_mul_ps(alpha, _mm_sub_ps(iw, ow))),
+			nx = _mm_add_ps(ox, _mm_mul_ps(alpha, _mm_sub_ps(ix, ox))),
+			ny = _mm_add_ps(oy, _mm_mul_ps(alpha, _mm_sub_ps(iy, oy))),
+			nz = _mm_add_ps(oz, _mm_mul_ps(alpha, _mm_sub_ps(iz, oz)));
+		__m128 inv_len = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(nw, nw), _mm_mul_ps(nx, nx)), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz))));
+
+		// only active lanes take the new output, speed and input
+		_mm_storeu_ps(&w[i], _mm_or_ps(_mm_and_ps(active, _mm_mul_ps(nw, inv_len)), _mm_andnot_ps(active, ow)));
+		_mm_storeu_ps(&x[i], _mm_or_ps(_mm_and_ps(active, _mm_mul_ps(nx, inv_len)), _mm_andnot_ps(active, ox)));
+		_mm_storeu_ps(&y[i], _mm_or_ps(_mm_and_ps(active, _mm_mul_ps(ny, inv_len)), _mm_andnot_ps(active, oy)));
+		_mm_storeu_ps(&z[i], _mm_or_ps(_mm_and_ps(active, _mm_mul_ps(nz, inv_len)), _mm_andnot_ps(active, oz)));
+
+		_mm_storeu_ps(&speeds[i], _mm_or_ps(_mm_and_ps(active, speed), _mm_andnot_ps(active, _mm_loadu_ps(&speeds[i]))));
+		_mm_storeu_ps(&raw_w[i], _mm_or_ps(_mm_and_ps(active, _mm_loadu_ps(&in_w[i])), _mm_andnot_ps(active, _mm_loadu_ps(&raw_w[i]))));
+		_mm_storeu_ps(&raw_x[i], _mm_or_ps(_mm_and_ps(active, _mm_loadu_ps(&in_x[i])), _mm_andnot_ps(active, _mm_loadu_ps(&raw_x[i]))));
+		_mm_storeu_ps(&raw_y[i], _mm_or_ps(_mm_and_ps(active, _mm_loadu_ps(&in_y[i])), _mm_andnot_ps(active, _mm_loadu_ps(&raw_y[i]))));
+		_mm_storeu_ps(&raw_z[i], _mm_or_ps(_mm_and_ps(active, _mm_loadu_ps(&in_z[i])), _mm_andnot_ps(active, _mm_loadu_ps(&raw_z[i]))));
+		_mm_storeu_ps(&dts[i], zero);
+	}
+}
+#else
+void quat_filter::process_sse()
+{
+	process_scalar();
+}
+#endif
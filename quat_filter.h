@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "nd_device.h"
+
+using namespace std;
+
+// one euro filter for a batch of quaternion channels
+// jitter is smoothed with a low cutoff while the hand is still,
+// fast motion raises the cutoff to keep lag low
+// channels are stored as structure of arrays and processed four at a time
+// with SSE, a scalar loop computes the same where SSE is unavailable
+// both paths add and normalize in the same order, so they agree bit for bit
+// as long as the compiler does not contract multiply-adds
+class quat_filter
+{
+	// number of channels rounded up to the SIMD width
+	size_t num_channels, num_padded;
+
+	// filtered output
+	vector<float> w, x, y, z;
+	// input of the current step
+	vector<float> in_w, in_x, in_y, in_z;
+	// input of the previous step, for the speed estimate
+	vector<float> raw_w, raw_x, raw_y, raw_z;
+	// filtered angular speed in rad/s
+	vector<float> speeds;
+	// seconds since the channel's last input, 0 if there is no new input
+	vector<float> dts;
+	// cutoff in Hz while still
+	vector<float> min_cutoffs;
+	vector<chrono::steady_clock::time_point> timestamps;
+
+	// duration of the last process() call
+	float last_process_us;
+
+public:
+	// increase of the cutoff per rad/s of angular speed
+	float beta;
+	// cutoff of the speed estimate in Hz
+	float speed_cutoff;
+
+	quat_filter(size_t a_num_channels = 0);
+
+	// keeps the state of existing channels
+	void resize(size_t a_num_channels);
+
+	size_t size() const { return num_channels; }
+
+	void set_min_cutoff(size_t channel, float hz) { min_cutoffs[channel] = hz; }
+
+	float get_min_cutoff(size_t channel) const { return min_cutoffs[channel]; }
+
+	// new raw rotation of a channel, repeated timestamps leave the channel as is
+	void set_input(size_t channel, quat q, chrono::steady_clock::time_point t);
+
+	// filters all channels with new input
+	void process();
+
+	// the two paths process() picks from, their results match bit for bit
+	void process_scalar();
+	void process_sse();
+
+	quat get_output(size_t channel) const { return quat(w[channel], x[channel], y[channel], z[channel]); }
+
+	float get_last_process_us() const { return last_process_us; }
+};
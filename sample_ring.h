@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+
+using namespace std;
+
+// lock-free ring buffer for exactly one producer and one consumer thread
+// the producer drops new samples while the ring is full
+template <typename T, size_t capacity>
+class sample_ring
+{
+	// one slot stays empty to tell full from empty
+	T slots[capacity + 1];
+	// next slot to write (producer) and to read (consumer)
+	atomic<size_t> head, tail;
+
+	static size_t next(size_t i) { return (i + 1) % (capacity + 1); }
+
+public:
+	sample_ring()
+		: head(0), tail(0)
+	{}
+
+	// producer side, returns false if the sample was dropped
+	bool push(const T& sample)
+	{
+		size_t h = head.load(memory_order_relaxed);
+		if (next(h) == tail.load(memory_order_acquire))
+		{
+			return false;
+		}
+
+		slots[h] = sample;
+		head.store(next(h), memory_order_release);
+		return true;
+	}
+
+	// consumer side, returns false if the ring is empty
+	bool pop(T& sample)
+	{
+		size_t t = tail.load(memory_order_relaxed);
+		if (t == head.load(memory_order_acquire))
+		{
+			return false;
+		}
+
+		sample = slots[t];
+		tail.store(next(t), memory_order_release);
+		return true;
+	}
+
+	// consumer side, drains the ring and keeps only the newest sample
+	// returns false and leaves sample untouched if the ring is empty
+	bool pop_latest(T& sample)
+	{
+		size_t t = tail.load(memory_order_relaxed),
+			h = head.load(memory_order_acquire);
+		if (t == h)
+		{
+			return false;
+		}
+
+		size_t newest = (h + capacity) % (capacity + 1);
+		sample = slots[newest];
+		tail.store(h, memory_order_release);
+		return true;
+	}
+};
@@ -2,9 +2,10 @@
 
 void space::update()
 {
-	// to ensure realistic movement independent of frame rate
+	// to ensure realistic movement independent of the update rate
+	// fractional ms, updates are only a few ms apart
 	chrono::steady_clock::time_point now = chrono::steady_clock::now();
-	float ms_elapsed = chrono::duration_cast<chrono::milliseconds>(now - last_update).count();
+	float ms_elapsed = chrono::duration<float, milli>(now - last_update).count();
 
 	float distance_elapsed = speed_ahead * ms_elapsed;
 	vec3 angles = vec3(speed_pitch, speed_yaw, speed_roll);
@@ -13,7 +14,7 @@ void space::update()
 
 	if (distance_elapsed > 100.0f)
 	{
-		cout << "Rendering too slow. Not updating" << endl;
+		cout << "Simulation too slow. Not updating" << endl;
 		last_update = now;
 		return;
 	}
@@ -74,7 +75,7 @@ void space::update()
 // if a target has been hit, it is mirrored at the midpoint of the shell
 
 void space::fire() {
-	is_phaser_firing = true;
+	last_fire = chrono::steady_clock::now();
 
 	for (size_t i = num_stars; i < num_stars + num_targets; i++)
 	{
@@ -161,26 +162,32 @@ space::space(float a_r_in, float a_r_out)
 	origin = vec3(0, 0, -r_out);
 
 	num_targets = 0;
-	is_phaser_firing = false;
 
 	init();
 }
 
-void space::draw(context& ctx)
+void space::publish(space_state& s)
 {
-	update();
+	size_t num = num_stars + num_targets;
+	s.positions.assign(positions, positions + num);
+	s.radii.assign(radii, radii + num);
+	s.colors.assign(colors, colors + num);
+	s.is_phaser_firing = chrono::steady_clock::now() - last_fire < phaser_flash_duration;
+}
 
+void space::draw(context& ctx, const space_state& s)
+{
 	ctx.push_modelview_matrix();
 	ctx.mul_modelview_matrix(model_view_mat);
 
 	sphere_renderer& sr = ref_sphere_renderer(ctx);
-	sr.set_position_array(ctx, positions, num_stars + num_targets);
-	sr.set_radius_array(ctx, radii, num_stars + num_targets);
-	sr.set_color_array(ctx, colors, num_stars + num_targets);
+	sr.set_position_array(ctx, s.positions);
+	sr.set_radius_array(ctx, s.radii);
+	sr.set_color_array(ctx, s.colors);
 	sr.set_render_style(srs);
-	sr.render(ctx, 0, num_stars + num_targets);
+	sr.render(ctx, 0, s.positions.size());
 
-	if (is_phaser_firing)
+	if (s.is_phaser_firing)
 	{
 		rounded_cone_renderer& rcr = ref_rounded_cone_renderer(ctx);
 		rcr.set_position_array(ctx, phaser_positions);
@@ -188,7 +195,6 @@ void space::draw(context& ctx)
 		rcr.set_radius_array(ctx, phaser_radii);
 		rcr.set_render_style(rcrs);
 		rcr.render(ctx, 0, phaser_indices.size());
-		is_phaser_firing = false;
 	}
 
 	ctx.pop_modelview_matrix();
@@ -13,6 +13,15 @@
 
 using namespace std;
 
+// stars, targets and phasers as drawn, published by the simulation
+struct space_state
+{
+	vector<cgv::render::render_types::vec3> positions;
+	vector<float> radii;
+	vector<cgv::render::render_types::rgb> colors;
+	bool is_phaser_firing = false;
+};
+
 class space
 	: public cgv::render::drawable
 {
@@ -44,7 +53,9 @@ class space
 	normal_distribution<float> dis_radii;
 
 	// phasers
-	bool is_phaser_firing;
+	// a shot stays visible for phaser_flash_duration, ticks are far shorter than frames
+	chrono::steady_clock::time_point last_fire;
+	const chrono::milliseconds phaser_flash_duration = chrono::milliseconds(25);
 	const vec3 phaser_loc = vec3(2.5f, .0f, -6.0f);
 	vector<vec3> phaser_positions, phaser_directions;
 	const vector<GLuint> phaser_indices = { 0, 1, 2, 3 };
@@ -56,8 +67,6 @@ class space
 	sphere_render_style srs;
 	rounded_cone_render_style rcrs;
 
-	void update();
-
 	// if a target has been hit, it is mirrored at the midpoint of the shell
 	void fire();
 
@@ -66,7 +75,13 @@ class space
 public:
 	space(float a_r_in, float a_r_out);
 
-	void draw(context& ctx);
+	// moves stars and targets by the time since the last update, called by the simulation
+	void update();
+
+	// copies the current state to s, a fired phaser is shown for phaser_flash_duration
+	void publish(space_state& s);
+
+	void draw(context& ctx, const space_state& s);
 	
 	static void set_speed_ahead(space* s, float val) { s->speed_ahead = val * s->max_speed_ahead; }
 	static void set_speed_pitch(space* s, float val) { s->speed_pitch = val * s->max_angular_speed; }
@@ -0,0 +1,17 @@
+#include <iostream>
+
+#include "tests.h"
+
+using namespace std;
+
+// runs all tests, returns the number of failed ones
+int main()
+{
+	int num_failed = 0;
+	num_failed += !test_sensor_allocations();
+	num_failed += !test_swing_twist();
+	num_failed += !test_quat_filter();
+
+	cout << (num_failed ? "FAILED: " : "all tests passed, ") << num_failed << " failed" << endl;
+	return num_failed;
+}
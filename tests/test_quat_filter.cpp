@@ -0,0 +1,70 @@
+// quat_filter's SSE and scalar paths give the same output bit for bit
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include "quat_filter.h"
+#include "tests.h"
+
+using namespace std;
+
+bool test_quat_filter()
+{
+	// not a multiple of the SIMD width, so the padding is covered too
+	const size_t num_channels = 21;
+	const int num_frames = 5000;
+
+	quat_filter sse_filter(num_channels), scalar_filter(num_channels);
+	mt19937 rng(5);
+	uniform_real_distribution<float> u(-1.0f, 1.0f), cutoff(.1f, 10.0f);
+	vector<quat> inputs(num_channels);
+	for (size_t c = 0; c < num_channels; c++)
+	{
+		inputs[c] = quat(u(rng), u(rng), u(rng), u(rng));
+		inputs[c].normalize();
+		float min_cutoff = cutoff(rng);
+		sse_filter.set_min_cutoff(c, min_cutoff);
+		scalar_filter.set_min_cutoff(c, min_cutoff);
+	}
+
+	chrono::steady_clock::time_point t = chrono::steady_clock::now();
+	int num_mismatched = 0;
+	for (int f = 0; f < num_frames; f++)
+	{
+		t += chrono::microseconds(500 + rng() % 1500);
+		for (size_t c = 0; c < num_channels; c++)
+		{
+			// some channels have no new input, others jump to the opposite hemisphere
+			if (rng() % 4 == 0)
+			{
+				continue;
+			}
+			vec3 axis(u(rng), u(rng), u(rng));
+			axis.normalize();
+			inputs[c] = quat(axis, .2f * u(rng)) * inputs[c];
+			inputs[c].normalize();
+			if (rng() % 50 == 0)
+			{
+				inputs[c] = quat(-inputs[c].w(), -inputs[c].x(), -inputs[c].y(), -inputs[c].z());
+			}
+			sse_filter.set_input(c, inputs[c], t);
+			scalar_filter.set_input(c, inputs[c], t);
+		}
+
+		sse_filter.process_sse();
+		scalar_filter.process_scalar();
+		for (size_t c = 0; c < num_channels; c++)
+		{
+			quat a = sse_filter.get_output(c), b = scalar_filter.get_output(c);
+			float sse_out[4] = { a.w(), a.x(), a.y(), a.z() }, scalar_out[4] = { b.w(), b.x(), b.y(), b.z() };
+			num_mismatched += memcmp(sse_out, scalar_out, sizeof(sse_out)) != 0;
+		}
+	}
+
+	bool passed = num_mismatched == 0;
+	cout << "test_quat_filter: " << (passed ? "passed" : "FAILED") << ", " << num_frames << " frames of "
+		<< num_channels << " channels, " << num_mismatched << " outputs differ" << endl;
+	return passed;
+}
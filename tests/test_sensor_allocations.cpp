@@ -0,0 +1,93 @@
+// the steady-state sensor path allocates nothing:
+// mock glove -> glove_sampler thread -> sample_ring -> nd_device::snapshot() -> get_rel_cgv_rotations()
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#include "nd_device.h"
+#include "mock_backend.h"
+#include "tests.h"
+
+using namespace std;
+
+// every allocation of every thread
+static atomic<size_t> num_allocations(0);
+
+void* operator new(size_t size)
+{
+	num_allocations++;
+	void* p = malloc(size ? size : 1);
+	if (!p)
+	{
+		throw bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+bool test_sensor_allocations()
+{
+	const int num_warm_up = 10, num_iterations = 2000;
+
+	device_manager dm;
+	dm.add_backend(new mock_backend(1, 1000.0f));
+	dm.start();
+	chrono::steady_clock::time_point timeout = chrono::steady_clock::now() + chrono::seconds(5);
+	while (dm.get_number_of_devices() == 0 && chrono::steady_clock::now() < timeout)
+	{
+		this_thread::sleep_for(chrono::milliseconds(10));
+	}
+	// enumerating allocates, but is no part of the sensor path
+	dm.stop();
+	if (dm.get_number_of_devices() == 0)
+	{
+		cout << "test_sensor_allocations: FAILED, the mock glove did not connect" << endl;
+		return false;
+	}
+
+	// starts the sampler and haptic threads
+	nd_device device(dm, 0);
+	imu_rotation_array rotations;
+	for (int i = 0; i < num_warm_up; i++)
+	{
+		device.snapshot();
+		this_thread::sleep_for(chrono::milliseconds(2));
+	}
+
+	size_t allocations_before = num_allocations;
+	int num_palm_samples = 0;
+	for (int i = 0; i < num_iterations; i++)
+	{
+		glove_snapshot s = device.snapshot();
+		device.get_rel_cgv_rotations(rotations);
+		num_palm_samples += s.num_palm_samples;
+		this_thread::sleep_for(chrono::microseconds(500));
+	}
+	size_t allocations = num_allocations - allocations_before;
+
+	if (num_palm_samples == 0)
+	{
+		cout << "test_sensor_allocations: FAILED, no samples arrived" << endl;
+		return false;
+	}
+	if (allocations != 0)
+	{
+		cout << "test_sensor_allocations: FAILED, " << allocations << " allocations in " << num_iterations << " frames" << endl;
+		return false;
+	}
+	cout << "test_sensor_allocations: passed, " << num_iterations << " frames and " << num_palm_samples << " samples without allocations" << endl;
+	return true;
+}
@@ -0,0 +1,128 @@
+// math_conversion::swing_twist_x() splits finger curl like the Euler decomposition it replaced
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "math_conversion.h"
+#include "tests.h"
+
+using namespace std;
+
+typedef cgv::math::quaternion<float> quat;
+typedef cgv::render::render_types::vec3 vec3;
+
+namespace
+{
+	const vec3 rot_split(.5f, .5f, .25f);
+
+	// fingertip rotation relative to the palm as hand::set_rotations() computed it with Euler angles
+	// returns false if the finger is not curled
+	bool euler_fingertip(const quat& rot, quat& tip)
+	{
+		float roll = atan2(
+			2 * (rot.w() * rot.x() + rot.y() * rot.z()),
+			1 - 2 * (rot.x() * rot.x() + rot.y() * rot.y())
+		);
+		if (roll > M_PI / 2)
+		{
+			roll -= 2 * float(M_PI);
+		}
+		if (roll >= 0)
+		{
+			return false;
+		}
+
+		float sinp = 2 * (rot.w() * rot.y() - rot.z() * rot.x()), pitch;
+		if (abs(sinp) >= 1)
+		{
+			pitch = copysign(float(M_PI) / 2, sinp);
+		}
+		else
+		{
+			pitch = asin(sinp);
+		}
+		float yaw = atan2(
+			2 * (rot.w() * rot.z() + rot.x() * rot.y()),
+			1 - 2 * (rot.y() * rot.y() + rot.z() * rot.z())
+		);
+
+		vec3 x(1, 0, 0), y(0, 1, 0), z(0, 0, 1);
+		tip = quat(z, yaw) * quat(y, pitch) * quat(x, rot_split.x() * roll)
+			* quat(x, rot_split.y() * roll) * quat(x, min(1.4f, rot_split.z() * roll));
+		tip.normalize();
+		return true;
+	}
+
+	// the same with the swing-twist split hand::set_rotations() uses now
+	bool swing_twist_fingertip(const quat& rot, quat& tip)
+	{
+		quat swing;
+		float curl_angle = math_conversion::swing_twist_x(rot, swing);
+		if (curl_angle > M_PI / 2)
+		{
+			curl_angle -= 2 * float(M_PI);
+		}
+		if (curl_angle >= 0)
+		{
+			return false;
+		}
+
+		vec3 x(1, 0, 0);
+		tip = swing * quat(x, rot_split.x() * curl_angle)
+			* quat(x, rot_split.y() * curl_angle) * quat(x, min(1.4f, rot_split.z() * curl_angle));
+		tip.normalize();
+		return true;
+	}
+
+	float angle_between_deg(const quat& a, const quat& b)
+	{
+		float d = abs(a.w() * b.w() + a.x() * b.x() + a.y() * b.y() + a.z() * b.z());
+		return 2 * acos(min(d, 1.0f)) * 180.0f / float(M_PI);
+	}
+}
+
+bool test_swing_twist()
+{
+	// fingertip orientations of both splits agree this closely on natural finger poses
+	const float max_mean_error_deg = .12f, max_error_deg = .5f;
+	const int num_rotations = 100000;
+	const float deg_to_rad = float(M_PI) / 180.0f;
+
+	// curl up to 140 degrees, spread up to 20 degrees and roll about the finger up to 10 degrees
+	mt19937 rng(1);
+	uniform_real_distribution<float> curl(-140.0f * deg_to_rad, .0f), spread(-20.0f * deg_to_rad, 20.0f * deg_to_rad),
+		roll(-10.0f * deg_to_rad, 10.0f * deg_to_rad);
+	double error_sum = 0;
+	float max_error = 0;
+	int num_compared = 0, num_mismatched = 0;
+	for (int i = 0; i < num_rotations; i++)
+	{
+		quat rot = quat(vec3(0, 0, 1), roll(rng)) * quat(vec3(0, 1, 0), spread(rng)) * quat(vec3(1, 0, 0), curl(rng));
+		quat euler_tip, swing_twist_tip;
+		bool is_euler_curled = euler_fingertip(rot, euler_tip),
+			is_swing_twist_curled = swing_twist_fingertip(rot, swing_twist_tip);
+		if (is_euler_curled != is_swing_twist_curled)
+		{
+			// both count barely curled fingers as stretched, at slightly different angles
+			num_mismatched++;
+			continue;
+		}
+		if (!is_euler_curled)
+		{
+			continue;
+		}
+
+		float error = angle_between_deg(euler_tip, swing_twist_tip);
+		error_sum += error;
+		max_error = max(max_error, error);
+		num_compared++;
+	}
+
+	float mean_error = num_compared ? float(error_sum / num_compared) : .0f;
+	bool passed = num_compared > num_rotations * 99 / 100 && mean_error <= max_mean_error_deg && max_error <= max_error_deg;
+	cout << "test_swing_twist: " << (passed ? "passed" : "FAILED") << ", " << num_compared << " rotations, fingertip differs by "
+		<< mean_error << " deg on average and " << max_error << " deg at most, " << num_mismatched << " differ in being curled" << endl;
+	return passed;
+}
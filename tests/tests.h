@@ -0,0 +1,12 @@
+#pragma once
+
+// each test prints its result and returns false if it failed
+
+// the steady-state sensor path allocates nothing
+bool test_sensor_allocations();
+
+// swing-twist finger curl matches the Euler decomposition it replaced
+bool test_swing_twist();
+
+// quat_filter's SSE and scalar paths agree bit for bit
+bool test_quat_filter();
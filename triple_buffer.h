@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+
+using namespace std;
+
+// lock-free hand-over of the newest state from exactly one writer to one reader thread
+// the writer never waits for the reader and the reader always sees a complete state,
+// states the reader does not pick up in time are overwritten
+template <typename T>
+class triple_buffer
+{
+	T slots[3];
+	// slot the writer fills and slot the reader holds
+	int back, front;
+	// last published slot, fresh_bit is set until the reader took it
+	atomic<int> middle;
+	static const int fresh_bit = 4;
+
+public:
+	triple_buffer()
+		: back(0), front(2), middle(1)
+	{}
+
+	// writer side, the slot to fill before publish()
+	// holds the state of two publishes ago, so members that rarely change can be kept
+	T& get_back() { return slots[back]; }
+
+	// writer side, hands the back slot to the reader
+	void publish()
+	{
+		back = middle.exchange(back | fresh_bit, memory_order_acq_rel) & ~fresh_bit;
+	}
+
+	// reader side, takes the newest published state if there is one
+	// returns false if nothing was published since the last call
+	bool update()
+	{
+		if ((middle.load(memory_order_relaxed) & fresh_bit) == 0)
+		{
+			return false;
+		}
+
+		front = middle.exchange(front, memory_order_acq_rel) & ~fresh_bit;
+		return true;
+	}
+
+	// reader side, the state taken by the last update()
+	const T& get_front() const { return slots[front]; }
+};
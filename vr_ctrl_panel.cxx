@@ -6,38 +6,21 @@ bool vr_ctrl_panel::init(context& ctx)
 	bool res = true;
 
 	cgv::gui::connect_vr_server(false);
-	nd_handler& ndh = nd_handler::instance();
-	res = res && nd_handler::instance().get_is_connected();
+	// gloves are connected in the background, hands appear in init_frame()
+	devices.add_backend(new ndapi_backend());
+	if (use_mock_gloves)
+	{
+		devices.add_backend(new mock_backend());
+	}
+	devices.start();
+	telemetry.start();
+	start_simulation();
 
 	cgv::render::ref_rounded_cone_renderer(ctx, 1);
 	cgv::render::ref_box_renderer(ctx, 1);
 	cgv::render::ref_sphere_renderer(ctx, 1);
 	cgv::render::ref_rectangle_renderer(ctx, 1);
 	
-	switch (ndh.get_app_mode())
-	{
-	case nd_handler::BOTH_HANDS:
-		hands.push_back(new hand(NDAPISpace::LOC_RIGHT_HAND, c.tracker_refs[0]));
-		existing_hand_locs.push_back(NDAPISpace::LOC_RIGHT_HAND);
-		hands.push_back(new hand(NDAPISpace::LOC_LEFT_HAND, c.tracker_refs[1]));
-		existing_hand_locs.push_back(NDAPISpace::LOC_LEFT_HAND);
-		break;
-	case nd_handler::LEFT_ONLY:
-		hands.push_back(nullptr);
-		hands.push_back(new hand(NDAPISpace::LOC_LEFT_HAND, c.tracker_refs[1]));
-		existing_hand_locs.push_back(NDAPISpace::LOC_LEFT_HAND);
-		break;
-	case nd_handler::RIGHT_ONLY:
-		hands.push_back(new hand(NDAPISpace::LOC_RIGHT_HAND, c.tracker_refs[0]));
-		existing_hand_locs.push_back(NDAPISpace::LOC_RIGHT_HAND);
-		hands.push_back(nullptr);
-		break;
-	default:
-		break;
-	}
-	hand_positions = vector<vec3>(hands.size(), vec3(0));
-	hand_orientations = vector<mat3>(hands.size());
-
 	hd.set_text("");
 
 	return res;
@@ -49,12 +32,16 @@ inline void vr_ctrl_panel::draw(cgv::render::context& ctx)
 	ctx.mul_modelview_matrix(c.model_view_mat);
 
 	//auto t0 = std::chrono::steady_clock::now();
+	scene.update();
+	const scene_state& s = scene.get_front();
 	if (c.render_hands)
 	{
-		for (auto loc : existing_hand_locs)
-			{
-				hands[loc]->update_and_draw(ctx, panel, hand_positions[loc], hand_orientations[loc]);
-			}
+		// hands are only appended, the scene may lag behind by one
+		for (size_t i = 0; i < min(hands.size(), s.hands.size()); i++)
+		{
+			hands[i]->draw(ctx, s.hands[i]);
+			latencies.record(POSE_TO_RENDER, s.hands[i].pose_time);
+		}
 	}
 	
 	//auto t1 = std::chrono::steady_clock::now();
@@ -66,7 +53,7 @@ inline void vr_ctrl_panel::draw(cgv::render::context& ctx)
 
 	if (c.render_panel)
 	{
-		panel.draw(ctx);
+		panel.draw(ctx, s.panel);
 	}
 
 	/*auto t2 = std::chrono::steady_clock::now();
@@ -79,11 +66,154 @@ inline void vr_ctrl_panel::draw(cgv::render::context& ctx)
 
 inline void vr_ctrl_panel::destruct(context& ctx)
 {
+	stop_simulation();
 	ref_rounded_cone_renderer(ctx, -1);
 	ref_sphere_renderer(ctx, -1);
 	ref_box_renderer(ctx, -1);
 	ref_rectangle_renderer(ctx, -1);
 	bridge.destruct(ctx);
+	for (auto h : hands)
+	{
+		h->clear(ctx);
+	}
+	delete_hands();
+}
+
+// copies the GUI controls to gui_settings for the next tick
+
+void vr_ctrl_panel::publish_settings()
+{
+	lock_guard<mutex> lock(settings_mutex);
+	gui_settings.render_hands = c.render_hands;
+	gui_settings.use_flex_sensors = use_flex_sensors;
+	gui_settings.prediction_horizon_ms = prediction_horizon_ms;
+	gui_settings.filter_beta = filter_beta;
+	gui_settings.filter_speed_cutoff = filter_speed_cutoff;
+	copy(imu_min_cutoffs, imu_min_cutoffs + max_num_imus, gui_settings.imu_min_cutoffs);
+}
+
+void vr_ctrl_panel::update_gloves()
+{
+	if (imu_filter.size() != hands.size() * max_num_imus)
+	{
+		imu_filter.resize(hands.size() * max_num_imus);
+	}
+	imu_filter.beta = settings.filter_beta;
+	imu_filter.speed_cutoff = settings.filter_speed_cutoff;
+
+	mat3 world_to_model_rot;
+	for (size_t i = 0; i < 3; i++)
+	{
+		for (size_t j = 0; j < 3; j++)
+		{
+			world_to_model_rot(i, j) = c.world_to_model(i, j);
+		}
+	}
+
+	for (size_t i = 0; i < hands.size(); i++)
+	{
+		hands[i]->set_use_flex(settings.use_flex_sensors);
+		hands[i]->get_fusion().set_world_to_model(world_to_model_rot);
+		hands[i]->update_glove();
+		const glove_snapshot& glove = hands[i]->get_glove();
+		for (size_t imu = 0; imu < max_num_imus; imu++)
+		{
+			size_t channel = i * max_num_imus + imu;
+			imu_filter.set_min_cutoff(channel, settings.imu_min_cutoffs[imu]);
+			imu_filter.set_input(channel, glove.rotations[imu], glove.timestamp);
+		}
+	}
+
+	imu_filter.process();
+
+	for (size_t i = 0; i < hands.size(); i++)
+	{
+		glove_snapshot& glove = hands[i]->get_glove();
+		for (size_t imu = 0; imu < max_num_imus; imu++)
+		{
+			glove.rotations[imu] = imu_filter.get_output(i * max_num_imus + imu);
+		}
+	}
+}
+
+void vr_ctrl_panel::start_simulation()
+{
+	if (is_simulating)
+	{
+		return;
+	}
+
+	publish_settings();
+	is_simulating = true;
+	simulation = thread(&vr_ctrl_panel::run_simulation, this);
+}
+
+void vr_ctrl_panel::stop_simulation()
+{
+	is_simulating = false;
+	if (simulation.joinable())
+	{
+		simulation.join();
+	}
+}
+
+void vr_ctrl_panel::run_simulation()
+{
+	chrono::steady_clock::time_point next_tick = chrono::steady_clock::now();
+	while (is_simulating)
+	{
+		tick();
+
+		// fixed rate, ticks missed e.g. while calibrating are skipped rather than caught up
+		next_tick += tick_period;
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		if (next_tick < now)
+		{
+			next_tick = now;
+		}
+		this_thread::sleep_until(next_tick);
+	}
+}
+
+void vr_ctrl_panel::tick()
+{
+	lock_guard<mutex> lock(simulation_mutex);
+	{
+		lock_guard<mutex> settings_lock(settings_mutex);
+		settings = gui_settings;
+	}
+	scene_state& s = scene.get_back();
+
+	if (settings.render_hands)
+	{
+		update_gloves();
+		chrono::steady_clock::time_point display_time = chrono::steady_clock::now()
+			+ chrono::microseconds((long long)(1000 * settings.prediction_horizon_ms));
+		s.hands.resize(hands.size());
+		for (size_t i = 0; i < hands.size(); i++)
+		{
+			hands[i]->update(panel, hand_positions[i], hand_orientations[i], hand_pose_times[i], display_time);
+			hands[i]->publish(s.hands[i]);
+			s.hands[i].pose_time = hand_pose_times[i];
+		}
+	}
+	else
+	{
+		s.hands.clear();
+	}
+
+	panel.update();
+	panel.publish(s.panel);
+	scene.publish();
+}
+
+void vr_ctrl_panel::delete_hands()
+{
+	for (auto h : hands)
+	{
+		delete h;
+	}
+	hands.clear();
 }
 
 // Inherited via event_handler
@@ -96,6 +226,8 @@ inline bool vr_ctrl_panel::handle(cgv::gui::event& e)
 
 	if (e.get_kind() == cgv::gui::EID_POSE)
 	{
+		// tracker poses and calibration change hands the simulation works on
+		lock_guard<mutex> lock(simulation_mutex);
 		cgv::gui::vr_pose_event& vrpe = static_cast<cgv::gui::vr_pose_event&>(e);
 		int t_id = vrpe.get_trackable_index();
 		mat3 ori_mat = vrpe.get_orientation();
@@ -111,9 +243,10 @@ inline bool vr_ctrl_panel::handle(cgv::gui::event& e)
 		{
 			if (c.tracker_assigns.count(t_id))
 			{
-				int tracker_loc = c.tracker_assigns[t_id];
-				hand_positions[tracker_loc] = math_conversion::inhom_pos(c.world_to_model * math_conversion::hom_pos(position));
-				hand_orientations[tracker_loc] = ori_mat;
+				int hand_index = c.tracker_assigns[t_id];
+				hand_positions[hand_index] = math_conversion::inhom_pos(c.world_to_model * math_conversion::hom_pos(position));
+				hand_orientations[hand_index] = ori_mat;
+				hand_pose_times[hand_index] = chrono::steady_clock::now();
 				update_calibration(vrpe.get_state(), t_id);
 				return true;
 			}
@@ -135,8 +268,19 @@ inline void vr_ctrl_panel::create_gui()
 	add_member_control(this, "render panel", c.render_panel, "toggle");
 	add_member_control(this, "render bridge", c.render_bridge, "toggle");
 	add_member_control(this, "load bridge mesh", c.load_bridge, "toggle");
+	add_member_control(this, "use flex sensors", use_flex_sensors, "toggle");
+	add_member_control(this, "prediction horizon (ms)", prediction_horizon_ms, "value_slider", "min=0;max=50;ticks=true");
+	add_member_control(this, "filter beta", filter_beta, "value_slider", "min=0;max=5;ticks=true");
+	add_member_control(this, "filter speed cutoff (Hz)", filter_speed_cutoff, "value_slider", "min=0.1;max=10;ticks=true");
+	const char* imu_names[] = { "palm", "thumb0", "thumb1", "index", "middle", "ring", "pinky", "chest", "arm", "forearm" };
+	for (size_t i = 0; i < max_num_imus; i++)
+	{
+		add_member_control(this, string("min cutoff ") + imu_names[i] + " (Hz)", imu_min_cutoffs[i], "value_slider", "min=0.1;max=10;ticks=true");
+	}
 	cgv::signal::connect_copy(add_button("reassign trackers")->click, rebind(this, &vr_ctrl_panel::reset_tracker_assigns));
 	cgv::signal::connect_copy(add_button("export calibration")->click, rebind(this, &vr_ctrl_panel::export_calibration));
+	cgv::signal::connect_copy(add_button("print metrics")->click, rebind(this, &vr_ctrl_panel::print_metrics));
+	cgv::signal::connect_copy(add_button("dump metrics")->click, rebind(this, &vr_ctrl_panel::dump_metrics));
 }
 
 void vr_ctrl_panel::update_calibration(vr::vr_kit_state state, int t_id)
@@ -149,10 +293,10 @@ void vr_ctrl_panel::update_calibration(vr::vr_kit_state state, int t_id)
 	if (c.is_signal_invalid)
 	{
 		c.is_signal_invalid = false;
-		for (auto loc : existing_hand_locs)
+		for (size_t i = 0; i < hands.size(); i++)
 		{
-			c.is_signal_invalid |= hands[loc]->is_in_ack_pose();
-			c.is_signal_invalid |= hands[loc]->is_in_decl_pose();
+			c.is_signal_invalid |= hands[i]->is_in_ack_pose();
+			c.is_signal_invalid |= hands[i]->is_in_decl_pose();
 		}
 	}
 
@@ -164,9 +308,9 @@ void vr_ctrl_panel::update_calibration(vr::vr_kit_state state, int t_id)
 	{
 		c.is_signal_invalid = true;
 		c.stage = ABORT;
-		for (auto loc : existing_hand_locs)
+		for (size_t i = 0; i < hands.size(); i++)
 		{
-			hands[loc]->init_interactive_pulse(hand::ABORT);
+			hands[i]->init_interactive_pulse(hand::ABORT);
 		}
 	}
 
@@ -232,10 +376,10 @@ void vr_ctrl_panel::update_calibration(vr::vr_kit_state state, int t_id)
 		hd.set_text("Move your hands as shown, fingers together.\nCalibration in " + s.str() + "s...");
 		calibrate_new_z(state);
 		calibrate_model_view(math_conversion::ave_pos(state.controller));
-		for (auto loc : existing_hand_locs)
+		for (size_t i = 0; i < hands.size(); i++)
 		{
-			hands[loc]->calibrate_to_mat(hand_orientations[loc]);
-			c.tracker_refs[loc] = hand_orientations[loc];
+			hands[i]->calibrate_to_mat(hand_orientations[i]);
+			c.tracker_refs[i] = hand_orientations[i];
 		}
 		if (time_to_calibration <= 0)
 		{
@@ -294,9 +438,9 @@ void vr_ctrl_panel::next_calibration_stage(bool set_interactive_pulse, bool inva
 		c.is_signal_invalid = invalidate_ack ? true : c.is_signal_invalid;
 		if (set_interactive_pulse)
 		{
-			for (auto loc : existing_hand_locs)
+			for (size_t i = 0; i < hands.size(); i++)
 			{
-				hands[loc]->init_interactive_pulse(hand::ACK);
+				hands[i]->init_interactive_pulse(hand::ACK);
 			}
 		}
 	}
@@ -306,9 +450,9 @@ void vr_ctrl_panel::reset_calibration_stage()
 {
 	if (c.stage != NOT_CALIBRATING && c.stage != REQUESTED)
 	{
-		for (auto loc : existing_hand_locs)
+		for (size_t i = 0; i < hands.size(); i++)
 		{
-			hands[loc]->init_interactive_pulse(hand::DONE);
+			hands[i]->init_interactive_pulse(hand::DONE);
 		}
 	}
 	set_boolean(c.render_hands, last_cal.render_hands);
@@ -325,12 +469,13 @@ void vr_ctrl_panel::abort_calibration(bool restore)
 	if (restore)
 	{
 		c = last_cal;
-		for (auto loc : existing_hand_locs)
+		for (size_t i = 0; i < hands.size(); i++)
 		{
-			hands[loc]->restore_last_calibration();
+			hands[i]->restore_last_calibration();
 		}
 	}
 	update_all_members();
+	publish_settings();
 }
 
 void vr_ctrl_panel::calibrate_new_z(const vr::vr_kit_state& state)
@@ -368,66 +513,107 @@ void vr_ctrl_panel::assign_trackers(cgv::gui::vr_pose_event& vrpe)
 		return;
 	}
 
-	if (c.tracker_assigns.size() == existing_hand_locs.size())
+	// gloves connect in the background, trackers wait for them
+	if (hands.empty())
 	{
-		reset_tracker_assigns();
+		return;
 	}
-	
-	if (c.tracker_assigns.size())
+
+	// a single glove keeps the first tracker until the next reset
+	if (hands.size() == 1)
 	{
-		auto controllers = vrpe.get_state().controller;
-		int other_id = -1;
+		if (c.tracker_assigns.empty())
+		{
+			c.tracker_assigns[t_id] = 0;
+		}
+		return;
+	}
 
-		for (size_t i = 0; i < 4; i++)
+	if (c.tracker_assigns.size() == hands.size())
+	{
+		reset_tracker_assigns();
+	}
+
+	// the closest other tracker is taken to be on the same user's other hand
+	auto controllers = vrpe.get_state().controller;
+	vec3 t_world = math_conversion::position_from_pose(controllers[t_id].pose);
+	int other_id = -1;
+	float min_dist = numeric_limits<float>::max();
+	for (size_t i = 0; i < 4; i++)
+	{
+		if (i != t_id && controllers[i].status == vr::VRS_TRACKED)
 		{
-			if (i != t_id && controllers[i].status == vr::VRS_TRACKED)
+			float dist = (math_conversion::position_from_pose(controllers[i].pose) - t_world).length();
+			if (dist < min_dist)
 			{
 				other_id = i;
+				min_dist = dist;
 			}
 		}
-		
-		if (other_id == -1)
-		{
-			cout << "Could not find second tracker!" << endl;
-			return;
-		}
+	}
 
-		vec3 user_pos, z_dir;
-		
-		if (vrpe.get_state().hmd.status == vr::VRS_TRACKED)
-		{
-			user_pos = math_conversion::position_from_pose(vrpe.get_state().hmd.pose);
-			z_dir = user_pos - math_conversion::ave_pos(controllers);
-			z_dir.y() = 0;
-			z_dir.normalize();
-		}
-		else
+	if (other_id == -1)
+	{
+		cout << "Could not find second tracker!" << endl;
+		return;
+	}
+
+	vec3 user_pos, z_dir;
+
+	if (vrpe.get_state().hmd.status == vr::VRS_TRACKED)
+	{
+		user_pos = math_conversion::position_from_pose(vrpe.get_state().hmd.pose);
+		z_dir = user_pos - math_conversion::ave_pos(controllers);
+		z_dir.y() = 0;
+		z_dir.normalize();
+	}
+	else
+	{
+		user_pos = c.user_position;
+		z_dir = c.z_dir;
+	}
+
+	vec3 t_pos = t_world - user_pos,
+		 other_pos = math_conversion::position_from_pose(controllers[other_id].pose) - user_pos;
+	float t_side = cross(t_pos, z_dir).y(),
+		other_side = cross(other_pos, z_dir).y();
+	if (t_side == other_side)
+	{
+		cout << "Could not assign trackers: inconclusive positions!" << endl;
+		return;
+	}
+
+	// of the two trackers, the one further left is on a left hand
+	int hand_index = find_unassigned_hand(t_side > other_side ? NDAPISpace::LOC_LEFT_HAND : NDAPISpace::LOC_RIGHT_HAND);
+	if (hand_index < 0)
+	{
+		cout << "Could not assign tracker: no glove left for this hand!" << endl;
+		return;
+	}
+	c.tracker_assigns[t_id] = hand_index;
+}
+
+int vr_ctrl_panel::find_unassigned_hand(NDAPISpace::Location location)
+{
+	for (size_t i = 0; i < hands.size(); i++)
+	{
+		if (hands[i]->get_location() != location)
 		{
-			user_pos = c.user_position;
-			z_dir = c.z_dir;
+			continue;
 		}
 
-		vec3 t_pos = math_conversion::position_from_pose(controllers[t_id].pose) - user_pos,
-			 other_pos = math_conversion::position_from_pose(controllers[other_id].pose) - user_pos;
-		if (cross(t_pos, z_dir).y() > 0 && cross(other_pos, z_dir).y() < 0)
+		bool is_assigned = false;
+		for (auto p : c.tracker_assigns)
 		{
-			c.tracker_assigns[t_id] = NDAPISpace::LOC_LEFT_HAND;
-			c.tracker_assigns[other_id] = NDAPISpace::LOC_RIGHT_HAND;
-		} 
-		else if (cross(t_pos, z_dir).y() < 0 && cross(other_pos, z_dir).y() > 0)
-		{
-			c.tracker_assigns[t_id] = NDAPISpace::LOC_RIGHT_HAND;
-			c.tracker_assigns[other_id] = NDAPISpace::LOC_LEFT_HAND;
+			is_assigned |= p.second == (int)i;
 		}
-		else
+		if (!is_assigned)
 		{
-			cout << "Could not assign trackers: inconclusive positions!" << endl;
+			return i;
 		}
-	} 
-	else
-	{
-		c.tracker_assigns[t_id] = existing_hand_locs[0];
 	}
+
+	return -1;
 }
 
 void vr_ctrl_panel::reset_tracker_assigns() {
@@ -451,17 +637,36 @@ void vr_ctrl_panel::export_calibration()
 	cal_file << to_string(c.user_position(0)) + " " + to_string(c.user_position(1)) + " " + to_string(c.user_position(2)) << endl;
 	cal_file << to_string(c.z_dir(0)) + " " + to_string(c.z_dir(1)) + " " + to_string(c.z_dir(2)) << endl;
 
-	cal_file << to_string(c.tracker_refs[0](0, 0)) + " " + to_string(c.tracker_refs[0](0, 1)) + " " + to_string(c.tracker_refs[0](0, 2)) + " ";
-	cal_file << to_string(c.tracker_refs[0](1, 0)) + " " + to_string(c.tracker_refs[0](1, 1)) + " " + to_string(c.tracker_refs[0](1, 2)) + " ";
-	cal_file << to_string(c.tracker_refs[0](2, 0)) + " " + to_string(c.tracker_refs[0](2, 1)) + " " + to_string(c.tracker_refs[0](2, 2)) << endl;
-	
-	cal_file << to_string(c.tracker_refs[1](0, 0)) + " " + to_string(c.tracker_refs[1](0, 1)) + " " + to_string(c.tracker_refs[1](0, 2)) + " ";
-	cal_file << to_string(c.tracker_refs[1](1, 0)) + " " + to_string(c.tracker_refs[1](1, 1)) + " " + to_string(c.tracker_refs[1](1, 2)) + " ";
-	cal_file << to_string(c.tracker_refs[1](2, 0)) + " " + to_string(c.tracker_refs[1](2, 1)) + " " + to_string(c.tracker_refs[1](2, 2)) << endl;
+	// one line per hand
+	for (auto& ref : c.tracker_refs)
+	{
+		cal_file << to_string(ref(0, 0)) + " " + to_string(ref(0, 1)) + " " + to_string(ref(0, 2)) + " ";
+		cal_file << to_string(ref(1, 0)) + " " + to_string(ref(1, 1)) + " " + to_string(ref(1, 2)) + " ";
+		cal_file << to_string(ref(2, 0)) + " " + to_string(ref(2, 1)) + " " + to_string(ref(2, 2)) << endl;
+	}
 	
 	cal_file.close();
 }
 
+void vr_ctrl_panel::dump_metrics()
+{
+	if (latencies.write_csv("latencies.csv"))
+	{
+		cout << "Latencies written to latencies.csv." << endl;
+	}
+	if (telemetry.write_csv("telemetry.csv"))
+	{
+		cout << "Device telemetry written to telemetry.csv." << endl;
+	}
+}
+
+void vr_ctrl_panel::print_metrics()
+{
+	cout << latencies.get_summary();
+	cout << telemetry.get_summary();
+	cout << "imu filter: " << imu_filter.get_last_process_us() << " us" << endl;
+}
+
 void vr_ctrl_panel::load_calibration()
 {
 	try
@@ -493,20 +698,20 @@ void vr_ctrl_panel::load_calibration()
 		{
 			cal_file >> c.z_dir(i);
 		}
-		for (size_t i = 0; i < 3; i++)
+		// as many hands as were exported
+		vector<mat3> tracker_refs;
+		mat3 ref;
+		while (cal_file >> ref(0, 0))
 		{
-			for (size_t j = 0; j < 3; j++)
+			for (size_t k = 1; k < 9; k++)
 			{
-				cal_file >> c.tracker_refs[0](i, j);
+				cal_file >> ref(k / 3, k % 3);
 			}
+			tracker_refs.push_back(ref);
 		}
-		for (size_t i = 0; i < 3; i++)
+		if (tracker_refs.size())
 		{
-			float foo;
-			for (size_t j = 0; j < 3; j++)
-			{
-				cal_file >> c.tracker_refs[1](i, j);
-			}
+			c.tracker_refs = tracker_refs;
 		}
 	}
 	catch (const std::exception&)
@@ -528,6 +733,46 @@ inline void vr_ctrl_panel::init_frame(context& ctx)
 	{
 		set_boolean(c.load_bridge, !bridge.init(ctx));
 	}
+
+	add_new_hands();
+
+	// strings are only built when the telemetry thread has polled again
+	if (telemetry.get_version() != shown_telemetry_version)
+	{
+		shown_telemetry_version = telemetry.get_version();
+		hd.set_status(telemetry.get_warnings());
+	}
+}
+
+void vr_ctrl_panel::add_new_hands()
+{
+	// one hand per glove, hands share their index with the device
+	// devices are never removed, so new ones are always appended
+	size_t num_devices = devices.get_number_of_devices();
+	if (hands.size() >= num_devices)
+	{
+		return;
+	}
+
+	lock_guard<mutex> lock(simulation_mutex);
+	for (size_t device = hands.size(); device < num_devices; device++)
+	{
+		if (device >= c.tracker_refs.size())
+		{
+			mat3 identity;
+			identity.identity();
+			c.tracker_refs.push_back(identity);
+		}
+		hands.push_back(new hand(devices, device, c.tracker_refs[device], &latencies));
+	}
+	hand_positions.resize(hands.size(), vec3(0));
+	mat3 identity;
+	identity.identity();
+	hand_orientations.resize(hands.size(), identity);
+	hand_pose_times.resize(hands.size());
+
+	// assignments made for fewer hands may block the new ones
+	reset_tracker_assigns();
 }
 
 inline vr_ctrl_panel::calibration::calibration()
@@ -4,6 +4,7 @@
 #include "stdafx.h"
 #include <iostream>
 #include <fstream>
+#include <limits>
 
 #include <cgv/base/register.h>
 #include <cgv/render/drawable.h>
@@ -20,12 +21,20 @@
 #include <cgv/signal/signal.h>
 
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
 
-#include "nd_handler.h"
+#include "device_manager.h"
+#include "ndapi_backend.h"
+#include "mock_backend.h"
 #include "hand.h"
+#include "quat_filter.h"
+#include "device_telemetry.h"
 #include "mesh.h"
 #include "math_conversion.h"
 #include "headup_display.h"
+#include "triple_buffer.h"
 
 using namespace std;
 
@@ -37,6 +46,28 @@ enum calibration_stage
 using namespace cgv::render;
 using namespace cgv::math;
 
+// GUI settings the simulation reads, copied once per tick
+struct simulation_settings
+{
+	bool render_hands;
+	// curl fingers by flex sensors on gloves that have them
+	bool use_flex_sensors;
+	// expected time from a simulation tick to display, added to now as the prediction target
+	float prediction_horizon_ms;
+	// see quat_filter::beta and quat_filter::speed_cutoff
+	float filter_beta, filter_speed_cutoff;
+	// filter cutoff in Hz per IMU location while the hand is still
+	float imu_min_cutoffs[max_num_imus];
+};
+
+// everything draw() needs, published by the simulation
+struct scene_state
+{
+	// one per hand, empty while hands are not rendered
+	vector<hand_state> hands;
+	panel_state panel;
+};
+
 class vr_ctrl_panel
 	: public cgv::base::base,
 	public cgv::render::drawable,
@@ -47,7 +78,9 @@ class vr_ctrl_panel
 	{
 		// settings that can be calibrated
 		mat4 model_view_mat, world_to_model, bridge_view_mat;
+		// per hand
 		vector<mat3> tracker_refs;
+		// tracker index to hand index
 		map<int, int> tracker_assigns;
 		vec3 user_position, z_dir;
 
@@ -73,11 +106,46 @@ class vr_ctrl_panel
 	};
 
 protected:
-	// hands
+	// gloves of all backends
+	device_manager devices;
+	// battery and connection state of devices' gloves
+	device_telemetry telemetry;
+	// telemetry version shown on the head up display
+	unsigned shown_telemetry_version;
+
+	// hands, one per glove of any user
 	vector<hand*> hands;
-	vector<NDAPISpace::Location> existing_hand_locs;
 	vector<vec3> hand_positions;
 	vector<mat3> hand_orientations;
+	// arrival of the last tracker pose per hand
+	vector<chrono::steady_clock::time_point> hand_pose_times;
+
+	// end-to-end latencies of all hands
+	latency_stats latencies;
+	// smooths the IMU rotations of all hands, channel is hand index * max_num_imus + IMU
+	quat_filter imu_filter;
+
+	// GUI controls, see simulation_settings
+	float imu_min_cutoffs[max_num_imus];
+	bool use_flex_sensors;
+	float prediction_horizon_ms;
+	float filter_beta, filter_speed_cutoff;
+
+	// simulation: gloves, hands, panel and space advance on their own thread at a fixed rate
+	// draw() only renders the last published scene
+	thread simulation;
+	atomic<bool> is_simulating;
+	// held by each tick, guards hands, their tracker poses and the calibration
+	// against the event handler and init_frame()
+	mutex simulation_mutex;
+	// settings of the current tick, only used by the simulation
+	simulation_settings settings;
+	// written by on_set(), guarded by settings_mutex
+	// apart from simulation_mutex, which may be held while a member is set
+	simulation_settings gui_settings;
+	mutex settings_mutex;
+	triple_buffer<scene_state> scene;
+	const chrono::microseconds tick_period = chrono::microseconds(2000);
 
 	// panel
 	conn_panel panel;
@@ -93,9 +161,27 @@ protected:
 	// calibration
 	calibration c, last_cal;
 
+	// add mock_backend's gloves for hands the NDAPI service has no glove for
+	bool use_mock_gloves;
+
 public:
 	vr_ctrl_panel()
-	{}
+		: telemetry(devices), shown_telemetry_version(0), use_flex_sensors(true), prediction_horizon_ms(11), is_simulating(false),
+		use_mock_gloves(false)
+	{
+		for (size_t i = 0; i < max_num_imus; i++)
+		{
+			imu_min_cutoffs[i] = 1.0f;
+		}
+		filter_beta = imu_filter.beta;
+		filter_speed_cutoff = imu_filter.speed_cutoff;
+	}
+
+	~vr_ctrl_panel()
+	{
+		stop_simulation();
+		delete_hands();
+	}
 
 	string get_type_name(void) const
 	{
@@ -107,16 +193,27 @@ public:
 		return rh.reflect_member("render_hands", c.render_hands)
 			&& rh.reflect_member("render_panel", c.render_panel)
 			&& rh.reflect_member("load_bridge", c.load_bridge)
-			&& rh.reflect_member("render_bridge", c.render_bridge);
+			&& rh.reflect_member("render_bridge", c.render_bridge)
+			&& rh.reflect_member("use_mock_gloves", use_mock_gloves)
+			&& rh.reflect_member("use_flex_sensors", use_flex_sensors)
+			&& rh.reflect_member("prediction_horizon_ms", prediction_horizon_ms)
+			&& rh.reflect_member("filter_beta", filter_beta)
+			&& rh.reflect_member("filter_speed_cutoff", filter_speed_cutoff);
 	}
 
 	void on_set(void* member_ptr)
 	{
 		update_member(member_ptr);
+		publish_settings();
 	}
 
 	bool init(context& ctx);
 
+	// stops the gloves' threads before devices goes down
+	void delete_hands();
+	// creates hands for gloves connected since the last frame
+	void add_new_hands();
+
 	// check if hand is in position relevant for calibration (e.g. index+thumb)
 	// and change state if so
 	void update_calibration(vr::vr_kit_state state, int t_index);
@@ -134,10 +231,33 @@ public:
 	// set c.tracker_assigns
 	void assign_trackers(cgv::gui::vr_pose_event& vrpe);
 
+	// index of the first hand at location without a tracker, -1 if there is none
+	int find_unassigned_hand(NDAPISpace::Location location);
+
 	void reset_tracker_assigns();
 
 	void export_calibration();
 
+	// latencies and device telemetry
+	void dump_metrics();
+
+	void print_metrics();
+
+	// copies the GUI controls to gui_settings for the next tick
+	void publish_settings();
+
+	// takes the gloves' snapshots and filters all their rotations in one batch
+	void update_gloves();
+
+	void start_simulation();
+
+	void stop_simulation();
+
+	void run_simulation();
+
+	// advances hands, panel and space by one step and publishes the scene
+	void tick();
+
 	void load_calibration();
 
 	void set_boolean(bool& b, bool new_val);